@@ -0,0 +1,29 @@
+#!/bin/sh
+# Count the C++ heap allocations of solving each instance of a small fixed
+# set with each engine, preloading tools/alloccount.so, and print one CSV
+# row per run. Runs stop after 20000 conflicts, so the counts of a build
+# only vary with the random engine's seed. Run it on two builds to compare.
+# usage: bench/alloc.sh [solver] [alloccount.so]
+
+SOLVER=${1:-./satSolver}
+SHIM=${2:-tools/alloccount.so}
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+case "$SHIM" in
+  /*) ;;
+  *) SHIM=$(pwd)/$SHIM ;;
+esac
+
+echo "instance,engine,result,allocations,allocated_bytes,peak_bytes"
+for run in ksat:16:3:3,random ksat:50:3:1,dpll ksat:50:3:1,cdcl \
+    ksat:150:3:2,dpll ksat:150:3:2,cdcl php:7,cdcl color:300:3:1:2,cdcl \
+    ksat:20000:3:1,cdcl; do
+  spec=${run%,*}
+  engine=${run#*,}
+  "$SOLVER" --generate "$spec" > "$TMP/instance.cnf" || exit 2
+  : > "$TMP/count"
+  result=$(ALLOCCOUNT_OUT="$TMP/count" LD_PRELOAD="$SHIM" "$SOLVER" --"$engine" \
+    --threads 0 --conflicts 20000 --time 60 "$TMP/instance.cnf" 2> /dev/null | head -n 1 | awk '{ print tolower( $1 ) }' | tr -d :)
+  set -- $(cat "$TMP/count")
+  echo "$spec,$engine,$result,$2,$4,$6"
+done
@@ -0,0 +1,59 @@
+#!/bin/sh
+# Solve the fixed corpus in corpus.txt with each listed engine and print one
+# CSV row per run. Exits non-zero if any answer contradicts the known result.
+# usage: bench/run.sh [solver] [timeout-seconds]
+
+SOLVER=${1:-./satSolver}
+TIMEOUT=${2:-10}
+CORPUS=$(dirname "$0")/corpus.txt
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+# kill runs that ignore their own time limit
+if command -v timeout >/dev/null 2>&1; then
+  GUARD="timeout $((TIMEOUT + 5))"
+else
+  GUARD=""
+fi
+
+field () {
+  sed -n "s/.*\"$1\": \"*\([a-z0-9.]*\)\"*.*/\1/p" "$2"
+}
+
+echo "instance,engine,expected,result,check,time,conflicts,propagations,conflicts_per_sec,propagations_per_sec"
+wrong=0
+while read spec expected engines; do
+  case "$spec" in
+    ''|'#'*) continue ;;
+  esac
+  "$SOLVER" --generate "$spec" > "$TMP/instance.cnf" || exit 2
+  for engine in $(echo "$engines" | tr ',' ' '); do
+    : > "$TMP/stats.json"
+    $GUARD "$SOLVER" --"$engine" --stats --time "$TIMEOUT" "$TMP/instance.cnf" \
+      > /dev/null 2> "$TMP/stats.json"
+    result=$(field result "$TMP/stats.json")
+    time=$(field solve "$TMP/stats.json")
+    conflicts=$(field conflicts "$TMP/stats.json")
+    props=$(field propagations "$TMP/stats.json")
+    result=${result:-unknown}
+    time=${time:-$TIMEOUT}
+    conflicts=${conflicts:-0}
+    props=${props:-0}
+    if [ "$result" = "$expected" ]; then
+      check=ok
+    elif [ "$result" = "unknown" ]; then
+      check=timeout
+    else
+      check=WRONG
+      wrong=$((wrong + 1))
+    fi
+    rates=$(awk -v t="$time" -v c="$conflicts" -v p="$props" \
+      'BEGIN { if ( t <= 0 ) t = 1e-6; printf "%.0f,%.0f", c / t, p / t }')
+    echo "$spec,$engine,$expected,$result,$check,$time,$conflicts,$props,$rates"
+  done
+done < "$CORPUS"
+
+if [ "$wrong" -gt 0 ]; then
+  echo "$wrong run(s) contradicted the known result" >&2
+  exit 1
+fi
@@ -0,0 +1,67 @@
+#include "budget.h"
+#include <atomic>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+std::atomic<bool> interruptRequested( false );
+
+SearchLimits::SearchLimits() {
+  timeout = 0;
+  maxConflicts = 0;
+  maxPropagations = 0;
+  maxDecisions = 0;
+  maxMemoryMB = 0;
+  interrupt = &interruptRequested;
+  cancel = nullptr;
+  ticks = 0;
+  reason = nullptr;
+  start = now();
+}
+
+// start the clock, call when the search starts
+void SearchLimits::begin() {
+  start = now();
+  ticks = 0;
+  reason = nullptr;
+}
+
+// check the budgets that cost a system call
+void SearchLimits::sample() {
+  if ( timeout > 0 && secondsSince( start ) > timeout )
+    reason = "time";
+  else if ( maxMemoryMB > 0 && currentMemoryMB() > maxMemoryMB )
+    reason = "memory";
+}
+
+long currentMemoryMB () {
+  long pages = 0;
+  FILE* f = fopen( "/proc/self/statm", "r" );
+  if ( f ) {
+    long size;
+    if ( fscanf( f, "%ld %ld", &size, &pages ) != 2 )
+      pages = 0;
+    fclose( f );
+    return pages * sysconf( _SC_PAGESIZE ) / ( 1024 * 1024 );
+  }
+  // no procfs: fall back to the peak resident size
+  struct rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+  return usage.ru_maxrss / 1024;
+}
+
+void interruptHandler ( int sig ) {
+  interruptRequested.store( true );
+}
+
+// without SA_RESTART, so a server blocked reading requests wakes up
+void installInterruptHandler () {
+  struct sigaction action;
+  memset( &action, 0, sizeof( action ) );
+  action.sa_handler = interruptHandler;
+  sigemptyset( &action.sa_mask );
+  sigaction( SIGINT, &action, NULL );
+  sigaction( SIGTERM, &action, NULL );
+}
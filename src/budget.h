@@ -0,0 +1,73 @@
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include <atomic>
+#include "stats.h"
+
+// Set from a signal handler or another thread to stop running searches.
+extern std::atomic<bool> interruptRequested;
+
+// The clock and memory usage are only sampled once per this many checks.
+#define BUDGET_CHECK_INTERVAL 64
+
+// Resource budgets for one solve, zero means unlimited. Counter budgets are
+// compared against the solver statistics, so they stop a search at exactly
+// the same point on every machine.
+struct SearchLimits {
+  double timeout; // seconds of search
+  unsigned long long maxConflicts;
+  unsigned long long maxPropagations;
+  unsigned long long maxDecisions;
+  long maxMemoryMB;
+  std::atomic<bool>* interrupt;
+  std::atomic<bool>* cancel; // stops only this search, may be null
+  timePoint start;
+  unsigned int ticks;
+  const char* reason; // why the search stopped, null while within budget
+  SearchLimits ();
+  void begin ();
+  void sample ();
+  bool exhausted ( SolverStats* stats );
+  bool expired ();
+};
+
+// cheap enough to call once per decision or conflict
+inline bool SearchLimits::exhausted ( SolverStats* stats ) {
+  if ( reason )
+    return true;
+  if ( maxConflicts && stats->conflicts >= maxConflicts )
+    reason = "conflicts";
+  else if ( maxPropagations && stats->propagations >= maxPropagations )
+    reason = "propagations";
+  else if ( maxDecisions && stats->decisions >= maxDecisions )
+    reason = "decisions";
+  else if ( interrupt->load( std::memory_order_relaxed ) )
+    reason = "interrupt";
+  else if ( cancel && cancel->load( std::memory_order_relaxed ) )
+    reason = "cancelled";
+  else if ( ++ticks % BUDGET_CHECK_INTERVAL == 0 )
+    sample();
+  return reason != nullptr;
+}
+
+// the clock, memory and stop flags only, for loops that count no conflicts
+// or decisions; samples on every call, so call it every few thousand steps
+inline bool SearchLimits::expired () {
+  if ( reason )
+    return true;
+  if ( interrupt->load( std::memory_order_relaxed ) )
+    reason = "interrupt";
+  else if ( cancel && cancel->load( std::memory_order_relaxed ) )
+    reason = "cancelled";
+  else
+    sample();
+  return reason != nullptr;
+}
+
+// resident set size of this process in megabytes
+long currentMemoryMB ();
+
+// route SIGINT and SIGTERM to interruptRequested
+void installInterruptHandler ();
+
+#endif
@@ -0,0 +1,93 @@
+#include "cardinality.h"
+#include "literal.h"
+#include <algorithm>
+#include <unordered_set>
+
+void CardSet::init ( const std::vector<Card>* cards, int numVars ) {
+  lits.clear();
+  start.assign( 1, 0 );
+  bound.clear();
+  occurs.resize( 2 * numVars + 2 );
+  for ( int l = 0; l < occurs.size(); l++ )
+    occurs[l].clear();
+  for ( int i = 0; i < cards->size(); i++ ) {
+    const Card& c = ( *cards )[i];
+    if ( c.bound >= (int) c.vars.size() )
+      continue; // always satisfied
+    for ( int k = 0; k < c.vars.size(); k++ ) {
+      int lit = 2 * c.vars[k] + c.polarity[k];
+      occurs[ lit ].push_back( bound.size() );
+      lits.push_back( lit );
+    }
+    start.push_back( lits.size() );
+    bound.push_back( c.bound );
+  }
+  count.assign( bound.size(), 0 );
+}
+
+int* CardSet::explain ( int i, int lit, const int8_t* values, const VarData* vars, int* size ) {
+  int member = litNeg( lit ); // the literal of i made false
+  int before = vars->position[ litVar( lit ) ];
+  reasonLits.clear();
+  reasonLits.push_back( lit );
+  for ( int k = start[i]; k < start[i + 1]; k++ ) {
+    int other = lits[k];
+    if ( other != member && values[ other ] == VALUE_TRUE && vars->position[ litVar( other ) ] < before )
+      reasonLits.push_back( litNeg( other ) );
+  }
+  *size = reasonLits.size();
+  return &reasonLits[0];
+}
+
+void recoverCards ( std::vector<Clause>* form, std::vector<Card>* cards ) {
+  // a binary clause -a | -b is an edge between the literals a and b
+  std::unordered_set<unsigned long long> edges;
+  std::vector< std::vector<int> > adjacent;
+  for ( int i = 0; i < form->size(); i++ ) {
+    Clause* c = &( *form )[i];
+    if ( c->numVars != 2 || c->vars[0] == c->vars[1] )
+      continue;
+    int a = 2 * c->vars[0] + !c->polarity[0];
+    int b = 2 * c->vars[1] + !c->polarity[1];
+    if ( std::max( a, b ) >= adjacent.size() )
+      adjacent.resize( std::max( a, b ) + 1 );
+    if ( edges.insert( (unsigned long long) std::min( a, b ) << 32 | std::max( a, b ) ).second ) {
+      adjacent[a].push_back( b );
+      adjacent[b].push_back( a );
+    }
+  }
+  // grow a clique greedily from each literal, most connected first
+  std::vector<int> order;
+  for ( int a = 0; a < adjacent.size(); a++ ) {
+    if ( adjacent[a].size() + 1 >= CARD_MIN_RECOVER )
+      order.push_back( a );
+  }
+  std::sort( order.begin(), order.end(), [&adjacent]( int a, int b ) {
+    return adjacent[a].size() > adjacent[b].size();
+  } );
+  std::vector<char> used( adjacent.size(), 0 );
+  std::vector<int> clique;
+  for ( int i = 0; i < order.size(); i++ ) {
+    int a = order[i];
+    if ( used[a] )
+      continue;
+    clique.assign( 1, a );
+    for ( int k = 0; k < adjacent[a].size(); k++ ) {
+      int b = adjacent[a][k];
+      bool joins = !used[b];
+      for ( int m = 1; m < clique.size() && joins; m++ )
+        joins = edges.count( (unsigned long long) std::min( b, clique[m] ) << 32 | std::max( b, clique[m] ) );
+      if ( joins )
+        clique.push_back( b );
+    }
+    if ( clique.size() < CARD_MIN_RECOVER )
+      continue;
+    Card card = { std::vector<unsigned int>(), std::vector<bool>(), 1, true };
+    for ( int k = 0; k < clique.size(); k++ ) {
+      used[ clique[k] ] = 1;
+      card.vars.push_back( litVar( clique[k] ) );
+      card.polarity.push_back( litSign( clique[k] ) );
+    }
+    cards->push_back( card );
+  }
+}
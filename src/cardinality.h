@@ -0,0 +1,44 @@
+#ifndef CARDINALITY_H
+#define CARDINALITY_H
+
+#include <vector>
+#include "solver.h"
+#include "clausedb.h"
+#include "vardata.h"
+
+// at-most-one constraints of at least CARD_MIN_RECOVER literals are
+// recovered from their pairwise encoding
+#define CARD_MIN_RECOVER 4
+
+// A literal implied by cardinality constraint i has the reason
+// CARD_REASON | i; its clause is only built when conflict analysis asks.
+#define CARD_REASON 0x80000000u
+
+inline bool isCardReason ( ClauseRef r ) {
+  return r != CLAUSE_NONE && ( r & CARD_REASON );
+}
+
+// At-most-k constraints as flat literal lists. count[i] is the number of
+// true literals of constraint i among the trail literals already
+// propagated; once it reaches the bound every other literal is false.
+struct CardSet {
+  std::vector<int> lits; // constraint i in [start[i], start[i + 1])
+  std::vector<int> start;
+  std::vector<int> bound;
+  std::vector<int> count;
+  std::vector< std::vector<int> > occurs; // constraints of each literal
+  std::vector<int> reasonLits; // the last explanation built
+  std::vector<int> trueLits; // scratch space of propagation
+  void init ( const std::vector<Card>* cards, int numVars );
+  bool empty () const { return bound.empty(); }
+  int size ( int i ) const { return start[i + 1] - start[i]; }
+  // Clause of constraint i implying lit: lit, then the negation of every
+  // literal of i true before it on the trail
+  int* explain ( int i, int lit, const int8_t* values, const VarData* vars, int* size );
+};
+
+// Find groups of at least CARD_MIN_RECOVER literals with a binary clause
+// forbidding every pair; each literal joins at most one group
+void recoverCards ( std::vector<Clause>* form, std::vector<Card>* cards );
+
+#endif
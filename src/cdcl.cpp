@@ -1,8 +1,12 @@
 #include <vector>
-#include <deque>
 #include "dpll.h"
 #include "cdcl.h"
 #include "solver.h"
+#include "localsearch.h"
+#include "checkpoint.h"
+#include "components.h"
+#include "memusage.h"
+#include "perfcounters.h"
 #include <stdlib.h>
 #include <iostream>
 #include <iterator>
@@ -12,314 +16,1180 @@
 // CDCL Class implementation
 CDCLSolver::CDCLSolver() : DPLLSolver() {
   decisionLevel = 0;
-  conf = { nullptr, 0, false };
   numAssigned = 0;
+  qhead = 0;
+  binHead = 0;
+  gaussHead = 0;
+  cardHead = 0;
+  nextReduce = REDUCE_FIRST;
+  reductions = 0;
+  stamp = 0;
+  nextRestart = RESTART_UNIT;
+  walkInterval = WALK_INTERVAL;
+  walkPending = true;
+  chronoThreshold = CHRONO_THRESHOLD;
+  nextCheckpoint = CHECKPOINT_INTERVAL;
+  threads = 0;
+  memorySoftLimit = 0;
+  nextMemorySample = MEMORY_SAMPLE_INTERVAL;
+  formulaBytes = 0;
+  originalWords = 0;
+  trace = nullptr;
+  projectHead = 0;
 }
 
 CDCLSolver::CDCLSolver( std::vector<Clause> form, std::vector<int> sigma, int numClauses, int numVars
         , std::vector<int> activeClauses, int dLevel )
-  : DPLLSolver (form, sigma, numClauses, numVars, activeClauses) {
-  conf = { nullptr, 0, false };
+  : DPLLSolver ( std::move( form ), std::move( sigma ), numClauses, numVars, std::move( activeClauses ) ) {
   decisionLevel = dLevel;
-  std::vector<bool> finalVars;
+  qhead = 0;
+  binHead = 0;
+  gaussHead = 0;
+  cardHead = 0;
+  nextReduce = REDUCE_FIRST;
+  reductions = 0;
+  stamp = 0;
+  nextRestart = RESTART_UNIT;
+  walkInterval = WALK_INTERVAL;
+  walkPending = true;
+  chronoThreshold = CHRONO_THRESHOLD;
+  nextCheckpoint = CHECKPOINT_INTERVAL;
+  threads = 0;
+  memorySoftLimit = 0;
+  nextMemorySample = MEMORY_SAMPLE_INTERVAL;
+  formulaBytes = 0;
+  originalWords = 0;
+  trace = nullptr;
+  projectHead = 0;
 }
 
 void CDCLSolver::recordDecision ( decision d ) {
+  int lit = 2 * d.var + ( d.assignment < 0 );
   decisionLevel++;
-  sigma[ d.var ] = d.assignment;
-  sigmaStack.push_back( d.var );
+  trailLimits.push_back( trail.size() );
+  values[ lit ] = VALUE_TRUE;
+  values[ litNeg( lit ) ] = VALUE_FALSE;
+  vars.level[ d.var ] = decisionLevel;
+  vars.reason[ d.var ] = CLAUSE_NONE;
+  vars.position[ d.var ] = trail.size();
+  trail.push_back( lit );
   decisionStack.push( d );
-  numAssigned++;
-  level[ d.var ] = decisionLevel;
 }
 
-// Add node to implication graph
-void addNode ( CDCLSolver* solver, int index, int var ) {
-  (solver->reasons)[ var ].push_back( &(solver->formula[ index ]) ); 
-  solver->level[ var ] = solver->decisionLevel;
+// Add node to implication graph. The level is the highest level of the
+// other literals of the reason, which is below the current one when the
+// trail holds literals out of level order.
+inline void addNode ( CDCLSolver* solver, int lit, ClauseRef reason, int level ) {
+  int var = litVar( lit );
+  solver->values[ lit ] = VALUE_TRUE;
+  solver->values[ litNeg( lit ) ] = VALUE_FALSE;
+  solver->vars.level[ var ] = level;
+  solver->vars.reason[ var ] = reason;
+  solver->vars.position[ var ] = solver->trail.size();
+  solver->trail.push_back( lit );
 }
 
-// Remove node from implication graph
-void removeNode ( CDCLSolver* solver ) {
+// Watch the first two literals of a clause of size >= 2
+void attachClause ( CDCLSolver* solver, ClauseRef c ) {
+  int* lits = solver->db.lits( c );
+  std::vector< std::vector<Watcher> >& lists =
+    solver->db.size( c ) == 2 ? solver->binaries : solver->watches;
+  lists[ lits[0] ].push_back( { c, lits[1] } );
+  lists[ lits[1] ].push_back( { c, lits[0] } );
+}
+
+// a clause is locked while it is the reason of its first literal
+bool isLocked ( CDCLSolver* solver, ClauseRef c ) {
+  int first = solver->db.lits( c )[0];
+  return solver->vars.reason[ litVar( first ) ] == c && solver->values[ first ] == VALUE_TRUE;
+}
+
+// Position of a literal that is not false among lits[2..size), 0 if there
+// is none. SIZE fixes the clause size at compile time so the scan of short
+// clauses is unrolled; 0 reads it at run time.
+template<int SIZE>
+inline int findWatch ( const int8_t* values, const int* lits, int size ) {
+  int end = SIZE ? SIZE : size;
+  for ( int k = 2; k < end; k++ ) {
+    if ( values[ lits[k] ] != VALUE_FALSE )
+      return k;
+  }
+  return 0;
+}
 
+// Assign the literals implied by binary clauses for every trail literal
+// from binHead. Returns the conflicting clause or CLAUSE_NONE.
+ClauseRef propagateBinaries ( CDCLSolver* solver ) {
+  std::vector<int>& trail = solver->trail;
+  const int8_t* values = &solver->values[0];
+  while ( solver->binHead < trail.size() ) {
+    int p = trail[ solver->binHead++ ];
+    int level = solver->vars.level[ litVar( p ) ];
+    std::vector<Watcher>& bs = solver->binaries[ litNeg( p ) ];
+    for ( size_t i = 0; i < bs.size(); i++ ) {
+      int other = bs[i].blocker;
+      if ( values[ other ] == VALUE_TRUE )
+        continue;
+      if ( values[ other ] == VALUE_FALSE )
+        return bs[i].cref;
+      // the reason keeps its implied literal in position 0
+      int* lits = solver->db.lits( bs[i].cref );
+      lits[0] = other;
+      lits[1] = litNeg( p );
+      addNode( solver, other, bs[i].cref, level );
+      solver->stats->propagations++;
+    }
+  }
+  return CLAUSE_NONE;
 }
 
-// unit propagation
-void unitPropagate ( CDCLSolver* solver ) {
+// Two watched literal unit propagation over the trail from qhead. Binary
+// clauses are propagated for the whole trail before each literal's long
+// clauses. The implied literal of a reason clause is always kept in
+// position 0. Returns the conflicting clause or CLAUSE_NONE.
+ClauseRef unitPropagate ( CDCLSolver* solver ) {
+  ClauseRef confl = CLAUSE_NONE;
+  std::vector<int>& trail = solver->trail;
+  const int8_t* values = &solver->values[0];
+  ClauseDB& db = solver->db;
   while ( true ) {
-    Clause c;
-    pickClause( solver, &c );
-    if ( c.numVars == 0 ) {
-      // null clause
-      return;
+    confl = propagateBinaries( solver );
+    if ( confl != CLAUSE_NONE || solver->qhead == trail.size() )
+      break;
+    int falseLit = litNeg( trail[ solver->qhead++ ] );
+    std::vector<Watcher>& ws = solver->watches[ falseLit ];
+    size_t i = 0;
+    size_t j = 0;
+    while ( i < ws.size() ) {
+      Watcher w = ws[ i++ ];
+      if ( values[ w.blocker ] == VALUE_TRUE ) {
+        ws[ j++ ] = w;
+        continue;
+      }
+      ClauseRef c = w.cref;
+      if ( db.deleted( c ) )
+        continue; // removed clauses leave their watch lists lazily
+      int* lits = db.lits( c );
+      int size = db.size( c );
+      if ( lits[0] == falseLit ) {
+        lits[0] = lits[1];
+        lits[1] = falseLit;
+      }
+      w.blocker = lits[0];
+      if ( values[ lits[0] ] == VALUE_TRUE ) {
+        ws[ j++ ] = w;
+        continue;
+      }
+      // look for a replacement watch
+      int k;
+      switch ( size ) {
+        case 3: k = findWatch<3>( values, lits, size ); break;
+        case 4: k = findWatch<4>( values, lits, size ); break;
+        case 5: k = findWatch<5>( values, lits, size ); break;
+        default: k = findWatch<0>( values, lits, size ); break;
+      }
+      if ( k ) {
+        lits[1] = lits[k];
+        lits[k] = falseLit;
+        solver->watches[ lits[1] ].push_back( w );
+        continue;
+      }
+      ws[ j++ ] = w;
+      if ( values[ lits[0] ] == VALUE_FALSE ) {
+        confl = c;
+        while ( i < ws.size() )
+          ws[ j++ ] = ws[ i++ ];
+      } else {
+        // falseLit is nearly always at the current level, ending the scan
+        int level = 0;
+        for ( int k = 1; k < size && level < solver->decisionLevel; k++ ) {
+          int l = solver->vars.level[ litVar( lits[k] ) ];
+          if ( l > level )
+            level = l;
+        }
+        addNode( solver, lits[0], c, level );
+        solver->stats->propagations++;
+      }
     }
-    else if ( c.conflictIndex >= 0 ) {
-      // Create conflict
-      conflict con = { &( ( solver->formula )[c.conflictIndex] ), solver->decisionLevel, true };
-      solver->conf = con;
-      return;
+    ws.resize( j );
+    if ( confl != CLAUSE_NONE )
+      break;
+  }
+  if ( confl != CLAUSE_NONE ) {
+    solver->qhead = trail.size();
+    solver->binHead = trail.size();
+  }
+  return confl;
+}
+
+// Literals of a reason or conflict clause, the implied literal lit first
+// for reasons. The clause of a cardinality reason is built on demand and
+// only valid until the next call.
+inline int* reasonLits ( CDCLSolver* solver, ClauseRef r, int lit, int* size ) {
+  if ( isCardReason( r ) )
+    return solver->cardSet.explain( r & ~CARD_REASON, lit, &solver->values[0], &solver->vars, size );
+  *size = solver->db.size( r );
+  return solver->db.lits( r );
+}
+
+// Learn the first UIP clause of a conflict and bump the activity of every
+// variable involved. The clause is minimized by dropping literals whose
+// reason is already covered by the clause.
+void analyzeAndLearn ( CDCLSolver* solver, ClauseRef confl, learnedClause* lc ) {
+  std::vector<char>& seen = solver->seen;
+  std::vector<int>& trail = solver->trail;
+  VarData& vars = solver->vars;
+  lc->lits.clear();
+  lc->lits.push_back( 0 ); // room for the asserting literal
+  int pathCount = 0;
+  int p = -1;
+  int index = trail.size() - 1;
+  do {
+    int size;
+    int* lits = reasonLits( solver, confl, p, &size );
+    for ( int k = ( p < 0 ? 0 : 1 ); k < size; k++ ) {
+      int q = lits[k];
+      int v = litVar( q );
+      if ( !seen[ v ] && vars.level[ v ] > 0 ) {
+        seen[ v ] = 1;
+        vars.bump( v );
+        if ( vars.level[ v ] >= solver->decisionLevel )
+          pathCount++;
+        else
+          lc->lits.push_back( q );
+      }
     }
-    else {
-      // no conflict, apply unit rule
-      decision d = unitRule( &c, &(solver->sigma), &(solver->sigmaStack) );
-      // expand active clauses
-      if ( d.var <= 0 ) continue;
-      solver->numAssigned++;
-      (solver->sigma)[d.var] = d.assignment;
-      (solver->sigmaStack).push_back( d.var );
-      for ( int i = 0; i < solver->numClauses; i++ ) {
-        Clause c = solver->formula[i];
-        if ( c.hasLit( d.var ) ) { 
-          (solver->activeClauses).push_back( i );
+    // next marked variable of the conflict level on the trail, which may be
+    // interleaved with lower levels
+    while ( !seen[ litVar( trail[ index ] ) ] || vars.level[ litVar( trail[ index ] ) ] < solver->decisionLevel )
+      index--;
+    index--;
+    p = trail[ index + 1 ];
+    confl = vars.reason[ litVar( p ) ];
+    seen[ litVar( p ) ] = 0;
+    pathCount--;
+  } while ( pathCount > 0 );
+  lc->lits[0] = litNeg( p );
+  vars.decay();
+
+  // local minimization
+  size_t keep = 1;
+  std::vector<int>& dropped = solver->dropped;
+  dropped.clear();
+  for ( size_t k = 1; k < lc->lits.size(); k++ ) {
+    int v = litVar( lc->lits[k] );
+    ClauseRef r = vars.reason[ v ];
+    bool redundant = r != CLAUSE_NONE;
+    if ( redundant ) {
+      int size;
+      int* lits = reasonLits( solver, r, litNeg( lc->lits[k] ), &size );
+      for ( int m = 1; m < size; m++ ) {
+        int u = litVar( lits[m] );
+        if ( !seen[ u ] && vars.level[ u ] > 0 ) {
+          redundant = false;
+          break;
         }
       }
-      // Update implication info
-      addNode ( solver, c.index, d.var ); 
+    }
+    if ( redundant )
+      dropped.push_back( v );
+    else
+      lc->lits[ keep++ ] = lc->lits[k];
+  }
+  lc->lits.resize( keep );
+  for ( size_t k = 1; k < lc->lits.size(); k++ )
+    seen[ litVar( lc->lits[k] ) ] = 0;
+  for ( size_t k = 0; k < dropped.size(); k++ )
+    seen[ dropped[k] ] = 0;
+
+  // backjump to the highest level below the conflict, kept in position 1
+  lc->level = 0;
+  for ( size_t k = 1; k < lc->lits.size(); k++ ) {
+    int l = vars.level[ litVar( lc->lits[k] ) ];
+    if ( l > lc->level ) {
+      lc->level = l;
+      std::swap( lc->lits[1], lc->lits[k] );
+    }
+  }
+  // literal block distance: number of distinct levels in the clause
+  int stamp = ++solver->stamp;
+  lc->lbd = 0;
+  for ( size_t k = 0; k < lc->lits.size(); k++ ) {
+    int l = vars.level[ litVar( lc->lits[k] ) ];
+    if ( solver->levelStamp[ l ] != stamp ) {
+      solver->levelStamp[ l ] = stamp;
+      lc->lbd++;
     }
   }
 }
 
-bool operator==(const pair<int> lhs, const int rhs ) {
-  return ( lhs.fst == rhs );
+// Undo every level above the given one, saving the phase of every undone
+// variable. Literals of lower levels assigned after the given level began
+// are kept in order and propagated again.
+void cancelUntil ( CDCLSolver* solver, int level ) {
+  if ( solver->decisionLevel <= level )
+    return;
+  std::vector<int>& trail = solver->trail;
+  VarData& vars = solver->vars;
+  int limit = solver->trailLimits[ level ];
+  int j = limit;
+  CardSet& cards = solver->cardSet;
+  for ( int i = limit; i < trail.size(); i++ ) {
+    int lit = trail[ i ];
+    int v = litVar( lit );
+    // kept literals are counted again when propagation reaches them
+    for ( int k = 0; i < solver->cardHead && k < cards.occurs[ lit ].size(); k++ )
+      cards.count[ cards.occurs[ lit ][k] ]--;
+    if ( vars.level[ v ] <= level ) {
+      vars.position[ v ] = j;
+      trail[ j++ ] = lit;
+      continue;
+    }
+    solver->values[ lit ] = VALUE_UNDEF;
+    solver->values[ litNeg( lit ) ] = VALUE_UNDEF;
+    if ( !solver->xorMatrix.empty() && solver->xorMatrix.contains( v ) )
+      solver->xorMatrix.unassign( v );
+    vars.reason[ v ] = CLAUSE_NONE;
+    vars.phase[ v ] = litSign( lit ) ? VALUE_FALSE : VALUE_TRUE;
+    vars.insert( v );
+  }
+  trail.resize( j );
+  solver->trailLimits.resize( level );
+  solver->qhead = limit;
+  solver->binHead = limit;
+  solver->gaussHead = std::min( solver->gaussHead, limit );
+  if ( !solver->xorMatrix.empty() )
+    solver->xorMatrix.backtrack( level );
+  solver->cardHead = std::min( solver->cardHead, limit );
+  solver->decisionLevel = level;
+  solver->projectHead = 0;
+  while ( solver->decisionStack.size() > level )
+    solver->decisionStack.pop();
 }
 
-std::deque<pair<int>> getReasonQueue( CDCLSolver* solver, pair<int> current, std::deque<pair<int>>* cReasons ) {
-  std::deque<pair<int>> reasonQueue;
-  std::vector<Clause*> tmp;
-  tmp = (solver->reasons)[current.fst];
-  for ( int i= 0; i < tmp.size(); i++ ) {
-    Clause* c = tmp[i];
-    for (int j = 0; j < (c->vars).size(); j++ ) {
-      int v = c->vars[j];
-      if ( v == current.fst || (std::find( cReasons->begin(), cReasons->end(), v ) != cReasons->end() ) ) continue;
-      reasonQueue.push_back( { v, solver->level[v] } );
+// Back jump to given level after a conflict
+void backjump ( CDCLSolver* solver, int level ) {
+  if ( solver->decisionLevel <= level )
+    return;
+  int distance = solver->decisionLevel - level;
+  solver->stats->backjumps++;
+  solver->stats->backjumpDistance += distance;
+  if ( distance > solver->stats->maxBackjumpDistance )
+    solver->stats->maxBackjumpDistance = distance;
+  cancelUntil( solver, level );
+}
+
+// Highest level among the literals of a conflict and how many literals
+// are assigned at it
+int conflictLevel ( CDCLSolver* solver, ClauseRef confl, int* count ) {
+  int* lits = solver->db.lits( confl );
+  int size = solver->db.size( confl );
+  int level = 0;
+  *count = 0;
+  for ( int k = 0; k < size; k++ ) {
+    int l = solver->vars.level[ litVar( lits[k] ) ];
+    if ( l > level ) {
+      level = l;
+      *count = 1;
+    } else if ( l == level ) {
+      ( *count )++;
     }
   }
-  return reasonQueue;
+  return level;
 }
 
-bool isUIP ( std::deque<pair<int>> reasons, int levels ) {
-  std::vector<int> sums = std::vector<int>( levels + 1, 0 );
-  for (int i = 0; i < reasons.size(); i++ ) {
-    int level = reasons[i].snd;
-    if ( level > levels )
-      return false; 
-    sums[level]++;
-    if (sums[level] > 1)
-      return false;
+// Remove c from the watch list of lit
+void unwatch ( CDCLSolver* solver, int lit, ClauseRef c ) {
+  std::vector<Watcher>& ws = solver->watches[ lit ];
+  ws.erase( std::find_if( ws.begin(), ws.end(), [c]( const Watcher& w ) {
+    return w.cref == c;
+  } ) );
+}
+
+// A conflict with a single literal at the highest level, possible once
+// the trail is out of level order, has nothing to learn: that literal is
+// implied at the next highest level. Undo its level and assign it there.
+void assignMissed ( CDCLSolver* solver, ClauseRef confl, int level ) {
+  cancelUntil( solver, level - 1 );
+  int* lits = solver->db.lits( confl );
+  int size = solver->db.size( confl );
+  int watched[2] = { lits[0], lits[1] };
+  for ( int k = 0; k < size; k++ ) {
+    if ( solver->values[ lits[k] ] == VALUE_UNDEF )
+      std::swap( lits[0], lits[k] );
+  }
+  int second = 0;
+  for ( int k = 1; k < size; k++ ) {
+    int l = solver->vars.level[ litVar( lits[k] ) ];
+    if ( l > second || k == 1 ) {
+      second = l;
+      std::swap( lits[1], lits[k] );
+    }
+  }
+  for ( int k = 0; k < 2 && size > 2 && !solver->db.detached( confl ); k++ ) {
+    if ( watched[k] != lits[0] && watched[k] != lits[1] )
+      unwatch( solver, watched[k], confl );
+    if ( lits[k] != watched[0] && lits[k] != watched[1] )
+      solver->watches[ lits[k] ].push_back( { confl, lits[ 1 - k ] } );
   }
-  return true; //currentLevel;
+  addNode( solver, lits[0], confl, second );
 }
 
-int secondHighestLevel( std::deque<pair<int>>* reasons ) {
-  int max = 0;
-  int sndmax = 0;
-  for ( int i = 0; i < (*reasons).size(); i++ ) {
-    int cmp = (*reasons)[i].snd;
-    if ( cmp > max ) {
-      sndmax = max;
-      max = (*reasons)[i].snd;
+// Remove the detached clauses that are no longer reasons
+void dropDetached ( CDCLSolver* solver ) {
+  std::vector<ClauseRef>& rs = solver->detachedClauses;
+  size_t j = 0;
+  for ( size_t i = 0; i < rs.size(); i++ ) {
+    if ( isLocked( solver, rs[i] ) )
+      rs[ j++ ] = rs[i];
+    else
+      solver->db.remove( rs[i] );
+  }
+  rs.resize( j );
+}
+
+// Tell the XOR matrix about the literals assigned since gaussHead and
+// assign what its rows imply, one at a time so that every row is checked
+// against the current assignment. Implied literals get a detached reason
+// clause; so does a violated row, which is returned as the conflict.
+// Returns CLAUSE_NONE otherwise.
+ClauseRef gaussPropagate ( CDCLSolver* solver ) {
+  std::vector<int>& trail = solver->trail;
+  XorMatrix& matrix = solver->xorMatrix;
+  std::vector<int>& lits = solver->gaussLits;
+  ClauseDB& db = solver->db;
+  while ( true ) {
+    for ( ; solver->gaussHead < trail.size(); solver->gaussHead++ ) {
+      int lit = trail[ solver->gaussHead ];
+      if ( matrix.contains( litVar( lit ) ) )
+        matrix.assign( litVar( lit ), !litSign( lit ) );
     }
-    else if ( cmp > sndmax )
-      sndmax = cmp; 
-  }
-  return sndmax;
-}
-
-Clause assembleClause( std::deque<pair<int>>* reasons, CDCLSolver* solver ) {
-  int numv = (*reasons).size();
-  if ( numv == 0 )
-    return Clause ();
-  int index = solver->formula.size();
-  std::vector<unsigned int> vs;
-  std::vector<bool> isn;
-  for ( int i = 0; i < numv; i++ ) {
-    int v = (*reasons)[i].fst;
-    vs.push_back( v );
-    // reverse current state
-    isn.push_back( solver->sigma[ v ] > 0 );
-  }
-  return Clause(vs, isn,  numv, index);
-}
-
-int reasonIndex( std::deque<pair<int>>* reasons, int key ) {
-  int i;
-  for ( i = 0; i < (*reasons).size(); i++ ) {
-    if ( (*reasons)[i].fst == key )
-      return i;
-  }
-  return -1;
-}
-
-void analyzeAndLearn ( CDCLSolver* solver, learnedClause* lc ) {
-  learnedClause learned = {-1, Clause()};
-  std::vector<unsigned int> conflictVars = solver->conf.clause->vars;
-  std::deque<pair<int>> reasons; //fst: var, snd: decision level
-  std::vector<bool> checked = std::vector<bool>(solver->numVars + 1, false);
-  // Initialize reasons with elements of conflict clause
-  for ( int i = 0; i < conflictVars.size(); i++ ) {
-    int v = conflictVars[i];
-    checked[v] = true;
-    reasons.push_back({ v, solver->level[v] });
-  }
-  pair<int> tmpr;
-  while ( !reasons.empty() && !isUIP( reasons, solver->decisionLevel ) ) { 
-    pair<int> cp = reasons.front();
-    int v = cp.fst;
-    reasons.pop_front();
-    std::deque<pair<int>> tmpc = getReasonQueue( solver, reasons.front() , &reasons );
-    if (!checked[v]) {
-      checked[v] = true;
-      reasons.push_back( { v, solver->level[v] } ); 
-    } 
-    reasons.insert( reasons.end(), tmpc.begin(), tmpc.end() );
-  }
-  int d = secondHighestLevel( &reasons );
-  Clause c = assembleClause( &reasons, solver );
-  learned.level = d;
-  learned.clause = c;
-  *lc = learned;
-}
-
-// Back jump to given level
-void backjump ( CDCLSolver* solver, int level ) {
-  // get relevant decision
-  decision dec = solver->decisionStack.top();
-  solver->decisionStack.pop();
-  while ( !solver->decisionStack.empty() && ( solver->level[ dec.var ] != level ) ) {
-    dec = solver->decisionStack.top();
+    int level;
+    int found = matrix.propagate( &solver->vars.level[0], &lits, &level );
+    if ( found == GAUSS_NONE )
+      return CLAUSE_NONE;
+    int size = lits.size();
+    if ( found == GAUSS_CONFLICT ) {
+      solver->stats->gaussConflicts++;
+      if ( size == 1 ) {
+        // a row of one column holds at level 0
+        if ( level == 0 )
+          return db.add( &lits[0], 1, true ); // removed with the solver
+        cancelUntil( solver, 0 );
+        addNode( solver, lits[0], CLAUSE_NONE, 0 );
+        return CLAUSE_NONE;
+      }
+      ClauseRef c = db.add( &lits[0], size, true );
+      db.detach( c );
+      solver->detachedClauses.push_back( c );
+      solver->qhead = trail.size();
+      solver->binHead = trail.size();
+      return c;
+    }
+    if ( size == 1 ) {
+      addNode( solver, lits[0], CLAUSE_NONE, 0 );
+    } else {
+      ClauseRef c = db.add( &lits[0], size, true );
+      db.detach( c );
+      solver->detachedClauses.push_back( c );
+      addNode( solver, lits[0], c, level );
+    }
+    solver->stats->gaussPropagations++;
+    solver->stats->propagations++;
+  }
+}
+
+// Count the trail literals from cardHead in the cardinality counters. A
+// constraint that reaches its bound makes its other literals false, with
+// the constraint itself as the reason; one with more true literals than
+// its bound is a conflict, returned as a detached clause.
+ClauseRef cardPropagate ( CDCLSolver* solver ) {
+  CardSet& cards = solver->cardSet;
+  std::vector<int>& trail = solver->trail;
+  const int8_t* values = &solver->values[0];
+  std::vector<int>& negated = cards.trueLits;
+  while ( solver->cardHead < trail.size() ) {
+    int p = trail[ solver->cardHead++ ];
+    const std::vector<int>& occurs = cards.occurs[p];
+    for ( size_t i = 0; i < occurs.size(); i++ )
+      cards.count[ occurs[i] ]++;
+    for ( size_t i = 0; i < occurs.size(); i++ ) {
+      int c = occurs[i];
+      if ( cards.count[c] < cards.bound[c] )
+        continue;
+      // every true literal, whether counted yet or not
+      const int* lits = &cards.lits[ cards.start[c] ];
+      int level = 0;
+      negated.clear();
+      for ( int k = 0; k < cards.size( c ); k++ ) {
+        if ( values[ lits[k] ] == VALUE_TRUE ) {
+          negated.push_back( litNeg( lits[k] ) );
+          level = std::max( level, solver->vars.level[ litVar( lits[k] ) ] );
+        }
+      }
+      if ( negated.size() > cards.bound[c] ) {
+        ClauseRef confl = solver->db.add( &negated[0], cards.bound[c] + 1, true );
+        solver->db.detach( confl );
+        solver->detachedClauses.push_back( confl );
+        solver->stats->cardConflicts++;
+        solver->qhead = trail.size();
+        solver->binHead = trail.size();
+        return confl;
+      }
+      for ( int k = 0; k < cards.size( c ); k++ ) {
+        if ( values[ lits[k] ] != VALUE_UNDEF )
+          continue;
+        addNode( solver, litNeg( lits[k] ), CARD_REASON | c, level );
+        solver->stats->cardPropagations++;
+        solver->stats->propagations++;
+      }
+    }
+  }
+  return CLAUSE_NONE;
+}
+
+// Unit propagation, cardinality counting and XOR elimination in turn until
+// none of them assigns anything. Returns the conflicting clause or
+// CLAUSE_NONE.
+ClauseRef propagateAll ( CDCLSolver* solver ) {
+  while ( true ) {
+    ClauseRef confl = unitPropagate( solver );
+    if ( confl != CLAUSE_NONE )
+      return confl;
+    if ( !solver->cardSet.empty() ) {
+      confl = cardPropagate( solver );
+      if ( confl != CLAUSE_NONE )
+        return confl;
+      if ( solver->qhead < solver->trail.size() )
+        continue;
+    }
+    if ( solver->xorMatrix.empty() )
+      return CLAUSE_NONE;
+    confl = gaussPropagate( solver );
+    if ( confl != CLAUSE_NONE || solver->qhead == solver->trail.size() )
+      return confl;
+  }
+}
+
+// i-th element, counting from 1, of the Luby sequence 1 1 2 1 1 2 4 1 ...
+unsigned long long luby ( unsigned long long i ) {
+  while ( true ) {
+    int k = 1;
+    while ( ( 1ULL << k ) - 1 < i )
+      k++;
+    if ( ( 1ULL << k ) - 1 == i )
+      return 1ULL << ( k - 1 );
+    i -= ( 1ULL << ( k - 1 ) ) - 1;
+  }
+}
+
+void restart ( CDCLSolver* solver ) {
+  cancelUntil( solver, 0 );
+  dropDetached( solver );
+  SolverStats* stats = solver->stats;
+  stats->restarts++;
+  traceEvent( solver->trace, TRACE_RESTART, stats->restarts, stats->conflicts, 0 );
+  solver->nextRestart = stats->conflicts + RESTART_UNIT * luby( stats->restarts + 1 );
+  if ( solver->walkInterval > 0 && stats->restarts % solver->walkInterval == 0 )
+    solver->walkPending = true;
+}
+
+// Run local search on the original clauses simplified by the level 0
+// assignment, starting from the saved phases, until its flip budget or the
+// search limits run out. If it gets close enough to a model, its best
+// assignment becomes the saved phases.
+void rephaseByWalk ( CDCLSolver* solver, SearchLimits* limits ) {
+  SolverStats* stats = solver->stats;
+  ClauseDB& db = solver->db;
+  LocalSearch& ls = solver->walker;
+  ls.reset( solver->numVars, stats->walks + 1 );
+  std::vector<int> kept;
+  for ( int i = 0; i < solver->clauses.size(); i++ ) {
+    if ( i % WALK_POLL_FLIPS == 0 && limits->expired() )
+      return;
+    ClauseRef c = solver->clauses[i];
+    if ( db.deleted( c ) )
+      continue;
+    int* lits = db.lits( c );
+    kept.clear();
+    bool satisfied = false;
+    for ( int k = 0; k < db.size( c ) && !satisfied; k++ ) {
+      int8_t value = solver->values[ lits[k] ];
+      if ( value == VALUE_TRUE )
+        satisfied = true;
+      else if ( value == VALUE_UNDEF )
+        kept.push_back( lits[k] );
+    }
+    if ( !satisfied )
+      ls.addClause( &kept[0], kept.size() );
+  }
+  int numClauses = ls.start.size() - 1;
+  if ( numClauses == 0 )
+    return;
+  unsigned long long maxFlips = std::min( (unsigned long long) WALK_FLIPS_PER_CLAUSE * numClauses,
+      (unsigned long long) WALK_MAX_FLIPS );
+  int unsat = ls.walk( &solver->vars.phase, maxFlips, limits );
+  stats->walks++;
+  stats->walkFlips += ls.flips;
+  if ( (long long) unsat * 1000 <= (long long) numClauses * WALK_ACCEPT_PER_MILLE ) {
+    solver->vars.phase = ls.best;
+    stats->rephases++;
+  }
+}
+
+// Most active unassigned variable with its saved phase, var -1 if every
+// variable is assigned. Unassigned projection variables go first, in their
+// given order.
+decision pickBranch ( CDCLSolver* solver ) {
+  VarData& vars = solver->vars;
+  std::vector<int>& projection = solver->projection;
+  for ( ; solver->projectHead < projection.size(); solver->projectHead++ ) {
+    int v = projection[ solver->projectHead ];
+    if ( solver->values[ 2 * v ] == VALUE_UNDEF )
+      return { v, vars.phase[ v ] };
+  }
+  while ( !vars.heap.empty() ) {
+    int v = vars.removeMax();
+    if ( solver->values[ 2 * v ] == VALUE_UNDEF )
+      return { v, vars.phase[ v ] };
+  }
+  return { -1, 0 };
+}
+
+// Copy the live clauses into a fresh arena and rewrite every reference.
+// Reasons go first, then clauses in watch list order, so the clauses visited
+// when propagating one literal end up next to each other.
+void collectGarbage ( CDCLSolver* solver ) {
+  ClauseDB& db = solver->db;
+  ClauseDB to;
+  to.memory.reserve( db.words() - db.wasted );
+  std::vector<int>& trail = solver->trail;
+  for ( int i = 0; i < trail.size(); i++ ) {
+    ClauseRef& r = solver->vars.reason[ litVar( trail[i] ) ];
+    if ( r != CLAUSE_NONE && !isCardReason( r ) )
+      r = db.relocate( r, &to );
+  }
+  for ( int l = 0; l < solver->watches.size(); l++ ) {
+    std::vector<Watcher>& bs = solver->binaries[l];
+    for ( size_t i = 0; i < bs.size(); i++ )
+      bs[i].cref = db.relocate( bs[i].cref, &to );
+    std::vector<Watcher>& ws = solver->watches[l];
+    size_t j = 0;
+    for ( size_t i = 0; i < ws.size(); i++ ) {
+      if ( !db.deleted( ws[i].cref ) ) {
+        ws[ j ] = ws[i];
+        ws[ j++ ].cref = db.relocate( ws[i].cref, &to );
+      }
+    }
+    ws.resize( j );
+  }
+  std::vector<ClauseRef>* lists[4] = { &solver->learnts, &solver->clauses, &solver->detachedClauses, &solver->blocking };
+  for ( int k = 0; k < 4; k++ ) {
+    std::vector<ClauseRef>& cs = *lists[k];
+    size_t j = 0;
+    for ( size_t i = 0; i < cs.size(); i++ ) {
+      if ( !db.deleted( cs[i] ) )
+        cs[ j++ ] = db.relocate( cs[i], &to );
+    }
+    cs.resize( j );
+  }
+  db.memory.swap( to.memory );
+  db.wasted = 0;
+  solver->stats->garbageCollections++;
+}
+
+bool worseLearned ( ClauseDB* db, ClauseRef a, ClauseRef b ) {
+  if ( db->lbd( a ) != db->lbd( b ) )
+    return db->lbd( a ) > db->lbd( b );
+  return db->size( a ) > db->size( b );
+}
+
+// Remove the worse half of the learned clauses by LBD, keeping reasons and
+// glue clauses (LBD <= 2)
+void reduceLearned ( CDCLSolver* solver ) {
+  ClauseDB* db = &solver->db;
+  std::vector<ClauseRef>& ls = solver->learnts;
+  std::sort( ls.begin(), ls.end(), [db]( ClauseRef a, ClauseRef b ) {
+    return worseLearned( db, a, b );
+  } );
+  size_t half = ls.size() / 2;
+  size_t j = 0;
+  for ( size_t i = 0; i < ls.size(); i++ ) {
+    if ( i < half && db->lbd( ls[i] ) > 2 && !isLocked( solver, ls[i] ) ) {
+      db->remove( ls[i] );
+      solver->stats->deletedClauses++;
+    } else {
+      ls[ j++ ] = ls[i];
+    }
+  }
+  traceEvent( solver->trace, TRACE_REDUCE, j, ls.size() - j, 0 );
+  ls.resize( j );
+  dropDetached( solver );
+  solver->reductions++;
+  solver->nextReduce = solver->stats->conflicts + REDUCE_FIRST + solver->reductions * REDUCE_INC;
+  if ( db->wasted > db->words() * GARBAGE_FRACTION )
+    collectGarbage( solver );
+}
+
+// Remove every learned clause that is neither glue nor a reason, compact
+// the arena and give the spare capacity of the clause and watch lists back
+void shrinkLearned ( CDCLSolver* solver ) {
+  ClauseDB& db = solver->db;
+  std::vector<ClauseRef>& ls = solver->learnts;
+  size_t j = 0;
+  for ( size_t i = 0; i < ls.size(); i++ ) {
+    if ( db.lbd( ls[i] ) > 2 && !isLocked( solver, ls[i] ) ) {
+      db.remove( ls[i] );
+      solver->stats->deletedClauses++;
+    } else {
+      ls[ j++ ] = ls[i];
+    }
+  }
+  traceEvent( solver->trace, TRACE_REDUCE, j, ls.size() - j, 0 );
+  ls.resize( j );
+  dropDetached( solver );
+  collectGarbage( solver );
+  ls.shrink_to_fit();
+  solver->detachedClauses.shrink_to_fit();
+  for ( int l = 0; l < solver->watches.size(); l++ ) {
+    solver->watches[l].shrink_to_fit();
+    solver->binaries[l].shrink_to_fit();
+  }
+  solver->stats->memoryReductions++;
+}
+
+// Record the memory of the search and shrink it when above the soft limit
+void sampleMemory ( CDCLSolver* solver ) {
+  solver->nextMemorySample = solver->stats->conflicts + MEMORY_SAMPLE_INTERVAL;
+  size_t total = recordMemory( solver );
+  if ( solver->memorySoftLimit && total > solver->memorySoftLimit ) {
+    shrinkLearned( solver );
+    recordMemory( solver );
+  }
+}
+
+// Empty every list and size the outer vector, keeping the lists' storage
+void clearLists ( std::vector< std::vector<Watcher> >* lists, int size ) {
+  lists->resize( size );
+  for ( int i = 0; i < size; i++ )
+    ( *lists )[i].clear();
+}
+
+// Load the parsed formula into the clause arena. Assignments made by the
+// parser become level 0 units. Returns false if the formula is trivially
+// unsatisfiable.
+bool initSearch ( CDCLSolver* solver ) {
+  int n = solver->numVars;
+  std::vector<int> units;
+  for ( int i = 1; i < n + 1; i++ ) {
+    if ( solver->sigma[ i ] != 0 )
+      units.push_back( solver->sigma[ i ] > 0 ? 2 * i : 2 * i + 1 );
+  }
+  solver->decisionLevel = 0;
+  solver->qhead = 0;
+  solver->binHead = 0;
+  solver->trail.clear();
+  solver->trailLimits.clear();
+  while ( !solver->decisionStack.empty() )
     solver->decisionStack.pop();
+  solver->db.memory.clear();
+  solver->db.wasted = 0;
+  // the original clauses go into the arena without regrowing it
+  size_t words = 0;
+  for ( int i = 0; i < solver->numClauses; i++ )
+    words += CLAUSE_HEADER + solver->formula[i].numVars;
+  solver->db.memory.reserve( words );
+  solver->clauses.clear();
+  solver->learnts.clear();
+  solver->blocking.clear();
+  solver->detachedClauses.clear();
+  solver->gaussHead = 0;
+  solver->cardHead = 0;
+  solver->projectHead = 0;
+  solver->nextReduce = REDUCE_FIRST;
+  solver->reductions = 0;
+  solver->nextRestart = RESTART_UNIT;
+  solver->walkPending = solver->walkInterval > 0;
+  solver->nextCheckpoint = CHECKPOINT_INTERVAL;
+  solver->nextMemorySample = MEMORY_SAMPLE_INTERVAL;
+  solver->formulaBytes = 0;
+  solver->originalWords = 0;
+  solver->values.assign( 2 * n + 2, VALUE_UNDEF );
+  solver->vars.init( n );
+  clearLists( &solver->watches, 2 * n + 2 );
+  clearLists( &solver->binaries, 2 * n + 2 );
+  solver->seen.assign( n + 1, 0 );
+  solver->levelStamp.assign( n + 2, 0 );
+  solver->stamp = 0;
+  std::vector<int> lits;
+  std::vector<int> mark( 2 * n + 2, 0 );
+  // the pairwise clauses of a recovered at-most-one are left out
+  std::vector<int> amoOf( 2 * n + 2, -1 );
+  for ( int i = 0; i < solver->cards.size(); i++ ) {
+    const Card& c = solver->cards[i];
+    for ( int k = 0; k < c.vars.size() && c.encoded && c.bound == 1; k++ )
+      amoOf[ 2 * c.vars[k] + c.polarity[k] ] = i;
   }
-  //level = solver->level[ dec.var ];
-  int orig = solver->sigma[ dec.var ];
-  // Reset all relevant variables:
-  solver->decisionLevel = level; 
-  for ( int i = 1; i < solver->numVars + 1; i++ ) {
-    if ( solver->level[ i ] >= level && !solver->finalVars[ i ]) {
-      if ( solver->sigma[ i ] != 0 )
-        solver->numAssigned--;
-      solver->level[ i ] = 0;
-      solver->sigma[ i ] = 0;
-      solver->reasons[ i ].clear();
-    } 
-  }
-
-  // undo sigma stack
-  int vr = solver->sigmaStack.back();
-  while ( vr != dec.var ) {
-    solver->sigmaStack.pop_back();
-    vr = solver->sigmaStack.back();
-  }
-  // Reverse relevant decision
-  solver->sigma[dec.var] = -orig;
-  solver->sigmaStack.push_back( dec.var );
-  solver->level[dec.var] = level;
-  solver->finalVars[ dec.var ] = true;
-  solver->numAssigned++;
-  // Update active clauses:
-  Clause c;
   for ( int i = 0; i < solver->numClauses; i++ ) {
-    c = solver->formula[i];
-    if ( c.hasLit( dec.var ) ) {
-      (solver->activeClauses).push_back( i );
+    Clause* c = &solver->formula[i];
+    lits.clear();
+    bool tautology = false;
+    for ( int j = 0; j < c->numVars; j++ ) {
+      int lit = 2 * c->vars[j] + c->polarity[j];
+      if ( mark[ litNeg( lit ) ] == i + 1 )
+        tautology = true;
+      if ( mark[ lit ] == i + 1 )
+        continue; // duplicate
+      mark[ lit ] = i + 1;
+      lits.push_back( lit );
+    }
+    if ( tautology )
+      continue;
+    if ( lits.size() == 0 )
+      return false;
+    if ( lits.size() == 1 ) {
+      units.push_back( lits[0] );
+      continue;
     }
+    int amo = amoOf[ litNeg( lits[0] ) ];
+    if ( lits.size() == 2 && amo >= 0 && amo == amoOf[ litNeg( lits[1] ) ] )
+      continue;
+    ClauseRef cr = solver->db.add( &lits[0], lits.size(), false );
+    solver->clauses.push_back( cr );
+    solver->originalWords += CLAUSE_HEADER + lits.size();
+    attachClause( solver, cr );
+  }
+  solver->cardSet.init( &solver->cards, n );
+  solver->stats->cardConstraints = solver->cards.size();
+  for ( int i = 0; i < solver->cards.size(); i++ ) {
+    const Card& c = solver->cards[i];
+    if ( c.bound < 0 )
+      return false;
+    for ( int k = 0; k < c.vars.size() && c.bound == 0; k++ )
+      units.push_back( 2 * c.vars[k] + !c.polarity[k] );
   }
+  // the XORs are eliminated once here; XORs of one variable are assigned
+  // by the first propagation
+  bool consistent = solver->xorMatrix.init( &solver->xors, n );
+  solver->stats->xorConstraints = solver->xors.size();
+  solver->formulaBytes = formulaBytes( solver );
+  if ( !consistent )
+    return false;
+  for ( int i = 0; i < units.size(); i++ ) {
+    int value = solver->values[ units[i] ];
+    if ( value == VALUE_FALSE )
+      return false;
+    if ( value == VALUE_UNDEF )
+      addNode( solver, units[i], CLAUSE_NONE, 0 );
+  }
+  return true;
 }
 
+// Load the formula and propagate its level 0 units. Returns false if that
+// leads to a conflict.
+bool propagateRoot ( CDCLSolver* solver ) {
+  return initSearch( solver ) && propagateAll( solver ) == CLAUSE_NONE;
+}
 
-void cdclEval ( CDCLSolver solver, int timeout, int verbose ) {
-  solver.activeClauses = solver.getSingletons();
-  bool shouldOverride = false;
-  solver.decisionLevel = 0;
-  // initialize graph vectors:
-  solver.reasons = std::vector< std::vector<Clause*> > ( solver.numVars + 1, std::vector<Clause*>() );
-  solver.level = std::vector<int>( solver.numVars + 1, 0 );
-  solver.finalVars = std::vector<bool>( solver.numVars + 1, true );
-  for ( int i = 1; i < solver.numVars + 1; i++ ) {
-    bool bf = solver.sigma[ i ] != 0;
-    solver.finalVars[ i ] = bf;
-  }
-  time_t endTime = time( NULL ) + timeout;
-  std::vector<Clause*> reasonQueue;
-  learnedClause lc;
-  //Main loop: go until timeout
-  while( time( NULL ) <= endTime ) {
-    int realsum = 0;
-    for ( int cr = 1 ; cr < solver.numVars + 1; cr++ )
-      if ( solver.sigma[ cr ] != 0 )
-        realsum++;
-    // reset conflict tracker
-    solver.conf = { nullptr, solver.decisionLevel, false }; 
+// Save the level 0 units, phases, activities and learned clauses with a
+// small LBD
+void writeCheckpoint ( CDCLSolver* solver ) {
+  Checkpoint ckpt;
+  VarData& vars = solver->vars;
+  int n = solver->numVars;
+  ckpt.fingerprint = formulaFingerprint( solver );
+  ckpt.numVars = n;
+  for ( int i = 0; i < solver->trail.size(); i++ ) {
+    if ( vars.level[ litVar( solver->trail[i] ) ] == 0 )
+      ckpt.units.push_back( solver->trail[i] );
+  }
+  ckpt.phase = vars.phase;
+  ckpt.activity.assign( n + 1, 0 );
+  for ( int v = 1; v < n + 1; v++ )
+    ckpt.activity[v] = vars.activity[v] / vars.activityInc;
+  ClauseDB& db = solver->db;
+  for ( int i = 0; i < solver->learnts.size(); i++ ) {
+    ClauseRef c = solver->learnts[i];
+    if ( !db.deleted( c ) && db.lbd( c ) <= CHECKPOINT_MAX_LBD )
+      ckpt.addClause( db.lits( c ), db.size( c ), db.lbd( c ) );
+  }
+  if ( saveCheckpoint( &ckpt, solver->checkpointFile ) )
+    solver->stats->checkpoints++;
+  else
+    std::cerr << "c cannot write checkpoint " << solver->checkpointFile << "\n";
+  solver->nextCheckpoint = solver->stats->conflicts + CHECKPOINT_INTERVAL;
+}
+
+// Load a checkpoint of the same formula before the first propagation.
+// Learned clauses are attached as they are: watches on literals already
+// false are visited when propagation reaches them on the trail. Returns
+// false if a saved unit contradicts the formula's level 0 units.
+bool resumeCheckpoint ( CDCLSolver* solver ) {
+  Checkpoint ckpt;
+  if ( !loadCheckpoint( &ckpt, solver->resumeFile ) ) {
+    std::cerr << "c cannot read checkpoint " << solver->resumeFile << ", starting fresh\n";
+    return true;
+  }
+  if ( ckpt.numVars != solver->numVars || ckpt.fingerprint != formulaFingerprint( solver ) ) {
+    std::cerr << "c checkpoint " << solver->resumeFile << " is for another formula, starting fresh\n";
+    return true;
+  }
+  VarData& vars = solver->vars;
+  for ( int i = 0; i < ckpt.units.size(); i++ ) {
+    int value = solver->values[ ckpt.units[i] ];
+    if ( value == VALUE_FALSE )
+      return false;
+    if ( value == VALUE_UNDEF )
+      addNode( solver, ckpt.units[i], CLAUSE_NONE, 0 );
+  }
+  vars.phase = ckpt.phase;
+  vars.activityInc = 1;
+  vars.heap.clear();
+  for ( int v = 1; v < solver->numVars + 1; v++ ) {
+    vars.activity[v] = ckpt.activity[v];
+    vars.heapIndex[v] = -1;
+    vars.insert( v );
+  }
+  for ( int c = 0; c < ckpt.lbd.size(); c++ ) {
+    ClauseRef cr = solver->db.add( &ckpt.lits[ ckpt.start[c] ], ckpt.start[c + 1] - ckpt.start[c], true );
+    solver->db.setLbd( cr, ckpt.lbd[c] );
+    solver->learnts.push_back( cr );
+    attachClause( solver, cr );
+  }
+  return true;
+}
+
+// Record the memory and trace the result of a search that is ending
+void endSearch ( CDCLSolver* solver, int result ) {
+  recordMemory( solver );
+  traceEvent( solver->trace, TRACE_RESULT, result, solver->stats->conflicts, 0 );
+}
+
+void printModel ( CDCLSolver* solver ) {
+  std::cout << "lit  val \n";
+  for ( int i = 1; i < solver->numVars + 1; i++) {
+    std::cout << " " << i << "    " << solver->sigma[ i ] << "\n";
+  }
+}
+
+// Search from the current state until the formula is decided or a budget
+// runs out. On RESULT_SAT the model is left in sigma and on the trail.
+int cdclSearch ( CDCLSolver* solver, SearchLimits* limits, int verbose, timePoint solveStart ) {
+  SolverStats* stats = solver->stats;
+  timePoint phaseStart;
+  PerfCounters* counters = solver->counters;
+  unsigned long long countersStart[ PERF_COUNTERS ];
+  bool counted;
+  learnedClause& lc = solver->learned;
+  //Main loop: go until a budget runs out
+  while( !limits->exhausted( stats ) ) {
     // unit propagate
-    unitPropagate ( &solver );
-    shouldOverride = false;
+    phaseStart = now();
+    counted = phaseBegin( counters, countersStart );
+    int assigned = solver->trail.size();
+    ClauseRef confl = propagateAll( solver );
+    phaseEnd( counters, counted, countersStart, stats, PHASE_PROPAGATE );
+    double elapsed = secondsSince( phaseStart );
+    stats->propagateTime += elapsed;
+    traceEvent( solver->trace, TRACE_PROPAGATE, solver->trail.size() - assigned,
+        solver->decisionLevel, std::min( elapsed * 1e9, 2e9 ) );
     // If no conflicts, respond
-    if ( !solver.conf.isConflict ) {
-      if ( solver.numAssigned == solver.numVars ) {
+    if ( confl == CLAUSE_NONE ) {
+      if ( stats->conflicts >= solver->nextRestart ) {
+        restart( solver );
+        if ( !solver->checkpointFile.empty() && stats->conflicts >= solver->nextCheckpoint )
+          writeCheckpoint( solver );
+        continue; // propagate learned units at level 0 first
+      }
+      if ( stats->conflicts >= solver->nextReduce )
+        reduceLearned( solver );
+      if ( stats->conflicts >= solver->nextMemorySample )
+        sampleMemory( solver );
+      if ( solver->walkPending && solver->decisionLevel == 0 ) {
+        solver->walkPending = false;
+        rephaseByWalk( solver, limits );
+      }
+      if ( solver->trail.size() == solver->numVars ) {
         // All assigned
-        std::cout << "sat\n";
-        if ( verbose ) {
-          std::cout << "lit  val \n";
-          for ( int i = 1; i < solver.numVars + 1; i++) {
-            std::cout << " " << i << "    " << solver.sigma[ i ] << "\n";
-          }
-        }
-        return;
+        for ( int i = 1; i < solver->numVars + 1; i++ )
+          solver->sigma[ i ] = solver->values[ 2 * i ];
+        return RESULT_SAT;
       } else {
         // make decision
-        decision d = makeDecision ( &solver );
-        if ( d.var < 0 ) {
-          return;
-        }
-        solver.recordDecision( d ); 
-        // expand active clauses:
-        for ( int i = 0; i < solver.numClauses; i++ ) {
-          Clause c = solver.formula[i];
-          if ( c.hasLit( d.var ) ) {
-            solver.activeClauses.push_back( i );
-          }
-        }
+        decision d = pickBranch ( solver );
+        stats->decisions++;
+        solver->recordDecision( d );
+        traceEvent( solver->trace, TRACE_DECISION, d.assignment < 0 ? -d.var : d.var, solver->decisionLevel, 0 );
       }
     }
     // otherwise UNSAT or backtrack
     else {
-      // Analyze and learn!
-      analyzeAndLearn( &solver, &lc );
-      //analyzeAndLearn ( &solver );
-      if ( lc.level < 0  || solver.decisionStack.empty() ) {
+      stats->conflicts++;
+      if ( verbose && stats->conflicts % 1000 == 0 ) {
+        stats->solveTime = secondsSince( solveStart );
+        printStatsLine( stats, std::cerr );
+      }
+      int atLevel;
+      int level = conflictLevel( solver, confl, &atLevel );
+      if ( level == 0 ) {
         //UNSAT
-        std::cout << "unsat\n";
-        if ( verbose ) {
-          Clause* last = &solver.formula[ solver.numClauses - 1 ];
-          int tmpv;
-          for ( int k = 0; k < last->numVars; k++ ) {
-            tmpv = last->vars[k];
-            std::cout << ( last->polarity[k] ? "-" : "" ) << tmpv << " ";
-          }
-          std::cout << "\n";
-        }
-        return;
+        return RESULT_UNSAT;
       }
-      else {
-        // Back jump
-        backjump( &solver, lc.level ); //lc.level );
-        solver.formula.push_back( lc.clause );
-        solver.numClauses++;
-        solver.activeClauses.push_back( lc.clause.index );
-        lc = { -1, Clause() };
+      if ( atLevel == 1 ) {
+        assignMissed( solver, confl, level );
+        continue;
+      }
+      // analysis runs at the level of the conflict
+      cancelUntil( solver, level );
+      // Analyze and learn!
+      phaseStart = now();
+      counted = phaseBegin( counters, countersStart );
+      analyzeAndLearn( solver, confl, &lc );
+      phaseEnd( counters, counted, countersStart, stats, PHASE_ANALYZE );
+      stats->analyzeTime += secondsSince( phaseStart );
+      stats->learnedClauses++;
+      stats->learnedLiterals += lc.lits.size();
+      // Back jump, or only undo the conflict level if the jump is long
+      int target = lc.level;
+      if ( solver->chronoThreshold >= 0 && solver->decisionLevel - lc.level > solver->chronoThreshold ) {
+        target = solver->decisionLevel - 1;
+        stats->chronoBacktracks++;
+      }
+      counted = phaseBegin( counters, countersStart );
+      backjump( solver, target );
+      phaseEnd( counters, counted, countersStart, stats, PHASE_BACKJUMP );
+      traceEvent( solver->trace, TRACE_CONFLICT, lc.lits.size(), lc.lbd, target );
+      if ( lc.lits.size() == 1 ) {
+        addNode( solver, lc.lits[0], CLAUSE_NONE, 0 );
+      } else {
+        ClauseRef cr = solver->db.add( &lc.lits[0], lc.lits.size(), true );
+        solver->db.setLbd( cr, lc.lbd );
+        solver->learnts.push_back( cr );
+        attachClause( solver, cr );
+        addNode( solver, lc.lits[0], cr, lc.level );
       }
     }
   }
-  if ( time (NULL) > endTime ) {
+  return RESULT_UNKNOWN;
+}
+
+// Run the search until the formula is decided or a budget runs out. On
+// RESULT_SAT the model is left in sigma. Nothing is printed unless verbose,
+// which writes progress lines to stderr. The solver may be reused: every
+// structure is cleared, keeping its allocation, by the next call.
+int cdclSolve ( CDCLSolver* solver, SearchLimits* limits, int verbose ) {
+  SolverStats* stats = solver->stats;
+  stats->engine = "cdcl";
+  timePoint solveStart = now();
+  limits->begin();
+  int result = RESULT_UNSAT;
+  if ( initSearch( solver ) && ( solver->resumeFile.empty() || resumeCheckpoint( solver ) ) )
+    result = cdclSearch( solver, limits, verbose, solveStart );
+  endSearch( solver, result );
+  stats->solveTime = secondsSince( solveStart );
+  if ( result == RESULT_SAT ) {
+    stats->result = "sat";
+  } else if ( result == RESULT_UNSAT ) {
+    stats->result = "unsat";
+  } else {
+    stats->stopReason = limits->reason;
+    if ( !solver->checkpointFile.empty() )
+      writeCheckpoint( solver );
+  }
+  return result;
+}
+
+// Exclude the model on the trail, projected onto the projection variables,
+// from the rest of the search. Those are decided first, so the decisions of
+// the levels up to the highest projection variable's imply all of their
+// values and the negations of these decisions block exactly this
+// projection. Only that highest level is undone, where the clause flips its
+// decision. Returns false if there are no such decisions: the projection is
+// fixed at level 0 and no other one exists.
+// The blocking clauses of the models below the same decisions contain the
+// new clause and are removed, so as long as the search runs depth first
+// only about one clause per level stays, as in a DPLL enumeration.
+bool blockModel ( CDCLSolver* solver ) {
+  int top = solver->decisionLevel;
+  if ( !solver->projection.empty() ) {
+    top = 0;
+    for ( int i = 0; i < solver->projection.size(); i++ )
+      top = std::max( top, solver->vars.level[ solver->projection[i] ] );
+  }
+  // highest level first: the asserting literal, then the second watch
+  std::vector<int>& lits = solver->learned.lits;
+  lits.clear();
+  for ( int l = top; l > 0; l-- )
+    lits.push_back( litNeg( solver->trail[ solver->trailLimits[ l - 1 ] ] ) );
+  solver->stats->blockingLiterals += lits.size();
+  if ( lits.empty() )
+    return false;
+  // every literal of the new clause is false, a clause containing them all
+  // is subsumed; its implied literal is above top - 1, so it is no reason
+  // once that level is undone
+  ClauseDB& db = solver->db;
+  std::vector<char>& seen = solver->seen;
+  for ( size_t k = 0; k < lits.size(); k++ )
+    seen[ litVar( lits[k] ) ] = 1;
+  size_t kept = 0;
+  for ( size_t i = 0; i < solver->blocking.size(); i++ ) {
+    ClauseRef c = solver->blocking[i];
+    int* cl = db.lits( c );
+    size_t shared = 0;
+    for ( int k = 0; k < db.size( c ); k++ )
+      shared += seen[ litVar( cl[k] ) ] && solver->values[ cl[k] ] == VALUE_FALSE;
+    if ( shared == lits.size() )
+      db.remove( c );
+    else
+      solver->blocking[ kept++ ] = c;
+  }
+  solver->blocking.resize( kept );
+  for ( size_t k = 0; k < lits.size(); k++ )
+    seen[ litVar( lits[k] ) ] = 0;
+  cancelUntil( solver, top - 1 );
+  if ( lits.size() == 1 ) {
+    addNode( solver, lits[0], CLAUSE_NONE, 0 );
+    return true;
+  }
+  // kept with the original clauses, which are never reduced; binary ones
+  // are never removed, as binary watches are not checked for removal
+  ClauseRef cr = db.add( &lits[0], lits.size(), false );
+  solver->clauses.push_back( cr );
+  if ( lits.size() > 2 )
+    solver->blocking.push_back( cr );
+  attachClause( solver, cr );
+  addNode( solver, lits[0], cr, top - 1 );
+  if ( db.wasted > db.words() * GARBAGE_FRACTION )
+    collectGarbage( solver );
+  return true;
+}
+
+void cdclEval ( CDCLSolver* solver, SearchLimits* limits, int verbose ) {
+  SolverStats localStats;
+  if ( !solver->stats )
+    solver->stats = &localStats;
+  // checkpoints describe one search of the whole formula
+  bool split = solver->threads > 0 && solver->checkpointFile.empty() && solver->resumeFile.empty();
+  int result = split ? solveComponents( solver, limits, solver->threads, verbose )
+    : cdclSolve( solver, limits, verbose );
+  if ( result == RESULT_SAT ) {
+    std::cout << "sat\n";
+    if ( verbose )
+      printModel( solver );
+  } else if ( result == RESULT_UNSAT ) {
+    std::cout << "unsat\n";
+  } else {
     std::cout << "unknown";
     if ( verbose ) {
       std::cout << "decisions: \n";
       decision dec;
-      while ( !solver.decisionStack.empty() ) {
-        dec = solver.decisionStack.top();
+      while ( !solver->decisionStack.empty() ) {
+        dec = solver->decisionStack.top();
         std::cout << dec.var << ": " << ( dec.assignment == 1 ) << "\n";
-        solver.decisionStack.pop();
+        solver->decisionStack.pop();
       }
     }
   }
+  if ( solver->stats == &localStats )
+    solver->stats = nullptr;
 }
@@ -2,30 +2,145 @@
 #define CDCL_H
 
 #include <vector>
+#include <string>
 #include "solver.h"
 #include "dpll.h"
+#include "budget.h"
+#include "clausedb.h"
+#include "literal.h"
+#include "vardata.h"
+#include "gauss.h"
+#include "cardinality.h"
+#include "trace.h"
+#include "localsearch.h"
+
+// learned clause database schedule: reduce after REDUCE_FIRST conflicts and
+// then every REDUCE_FIRST + k * REDUCE_INC conflicts, collect garbage once
+// this fraction of the arena is held by removed clauses
+#define REDUCE_FIRST 2000
+#define REDUCE_INC 300
+#define GARBAGE_FRACTION 0.2
+
+// restarts follow the Luby sequence in units of RESTART_UNIT conflicts. At
+// the start and every walkInterval restarts a local search of
+// WALK_FLIPS_PER_CLAUSE flips per clause, at most WALK_MAX_FLIPS, runs from
+// the saved phases and stops early with the search limits; its best
+// assignment replaces them if at most WALK_ACCEPT_PER_MILLE of the clauses
+// are left unsatisfied
+#define RESTART_UNIT 100
+#define WALK_INTERVAL 10
+#define WALK_FLIPS_PER_CLAUSE 20
+#define WALK_MAX_FLIPS 2000000
+#define WALK_ACCEPT_PER_MILLE 5
+
+// a backjump that would undo more than CHRONO_THRESHOLD levels only undoes
+// the current one; literals then stay on the trail above the start of lower
+// levels, so the trail is no longer sorted by level
+#define CHRONO_THRESHOLD 100
+
+// with a checkpoint file the state is saved at the first restart after every
+// CHECKPOINT_INTERVAL conflicts and when a budget runs out; learned clauses
+// with an LBD above CHECKPOINT_MAX_LBD are left out
+#define CHECKPOINT_INTERVAL 20000
+#define CHECKPOINT_MAX_LBD 8
+
+// the memory of the search is measured every MEMORY_SAMPLE_INTERVAL
+// conflicts; above the soft limit every learned clause that is neither glue
+// nor a reason is removed and the arena and lists are compacted
+#define MEMORY_SAMPLE_INTERVAL 1000
+
+// Entry of a watch list. The blocker is another literal of the clause; while
+// it is true the clause is skipped without touching the arena. For binary
+// clauses it is the other literal, so propagating them never reads the clause.
+struct Watcher {
+  ClauseRef cref;
+  int blocker;
+};
 
 struct learnedClause {
-  int level;
-  Clause clause;
+  int level; // backjump level
+  int lbd;
+  std::vector<int> lits; // encoded literals, asserting literal first
 };
 
 class CDCLSolver : public DPLLSolver {
 
   public:
     int decisionLevel;
-    conflict conf;
     CDCLSolver( std::vector<Clause> form, std::vector<int> sigma, int numClauses, int numVars
         , std::vector<int> activeClauses, int decisionLevel );
     CDCLSolver();
-    // decisionLimits is indexed inclusively:
-    // [0, m, n] where there are m-1 elements in decision 0, etc
-    std::vector< std::vector<Clause*> > reasons; // implication clauses
-    std::vector<int> level; // decision level for each variable
-    std::vector<bool> finalVars; // Un-reversable variables
+    ClauseDB db;
+    std::vector<ClauseRef> clauses; // original clauses in db
+    std::vector<ClauseRef> learnts; // learned clauses in db
+    // watch lists of clauses longer than two and binary clauses, both
+    // indexed by the watched literal and visited when it becomes false
+    std::vector< std::vector<Watcher> > watches;
+    std::vector< std::vector<Watcher> > binaries;
+    // value of every literal, kept for both polarities so testing a literal
+    // is a single load; sigma is only filled in with the final model
+    std::vector<int8_t> values;
+    VarData vars;
+    std::vector<int> trail; // assigned literals in order
+    std::vector<int> trailLimits; // trail size when level l + 1 began
+    int qhead; // next trail position to propagate long clauses for
+    int binHead; // next trail position to propagate binary clauses for
+    unsigned long long nextReduce; // conflict count of the next reduction
+    unsigned long long reductions;
+    unsigned long long nextRestart; // conflict count of the next restart
+    int walkInterval; // restarts between local search runs, 0 disables them
+    bool walkPending; // run local search before the next level 0 decision
+    int chronoThreshold; // longest non-chronological backjump, -1 for no limit
+    std::string checkpointFile; // where to save the search state, empty for never
+    std::string resumeFile; // state to load before searching, empty for none
+    unsigned long long nextCheckpoint; // conflict count of the next save
+    int threads; // for independent components, 0 searches the formula whole
+    size_t memorySoftLimit; // bytes, 0 for no limit
+    unsigned long long nextMemorySample; // conflict count of the next sample
+    size_t formulaBytes; // parsed formula and constraint structures
+    size_t originalWords; // arena words of the original clauses
+    TraceBuffer* trace; // search events are recorded here, null for none
+    // variables models are enumerated over, decided before all others so
+    // that the decisions on them imply their values; empty for all variables
+    std::vector<int> projection;
+    int projectHead; // the projection variables before it are assigned
+    std::vector<ClauseRef> blocking; // blocking clauses of found models in db
+    // XOR constraints, kept eliminated by Gauss-Jordan and checked once unit
+    // propagation is done, and cardinality constraints with a counter per
+    // constraint. Clauses derived from them for conflicts and XOR reasons
+    // are kept detached in the arena as long as they are reasons.
+    XorMatrix xorMatrix;
+    CardSet cardSet;
+    std::vector<ClauseRef> detachedClauses;
+    int gaussHead; // trail position up to which the matrix knows the assignment
+    int cardHead; // next trail position to count in the cardinality counters
+    std::vector<int> gaussLits; // clause of the last row the matrix resolved
+    std::vector<char> seen; // conflict analysis marks, indexed by variable
+    std::vector<int> levelStamp; // per level marks for computing LBD
+    int stamp;
+    learnedClause learned; // result of the last conflict analysis
+    std::vector<int> dropped; // variables removed by minimization
+    LocalSearch walker; // reused by every rephasing walk
     void recordDecision( decision d );
 };
 
-void cdclEval( CDCLSolver solver, int time, int verbose );
+int cdclSolve( CDCLSolver* solver, SearchLimits* limits, int verbose );
+
+// Continue a search set up by cdclSolve or initSearch from the current
+// trail; solveStart dates the progress lines
+int cdclSearch( CDCLSolver* solver, SearchLimits* limits, int verbose, timePoint solveStart );
+
+// Add a clause excluding the projection of the model on the trail and
+// backtrack so that it asserts; false once no other projection remains
+bool blockModel( CDCLSolver* solver );
+
+bool initSearch( CDCLSolver* solver );
+void endSearch( CDCLSolver* solver, int result );
+
+bool propagateRoot( CDCLSolver* solver );
+
+// Solve, splitting into components when threads is set, and print the
+// result; the model is left in sigma
+void cdclEval( CDCLSolver* solver, SearchLimits* limits, int verbose );
 
 #endif
@@ -0,0 +1,193 @@
+#include "checkpoint.h"
+#include "literal.h"
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <string.h>
+#include <stdio.h>
+
+Checkpoint::Checkpoint () {
+  fingerprint = 0;
+  numVars = 0;
+  start.push_back( 0 );
+}
+
+void Checkpoint::addClause ( const int* clause, int size, int clauseLbd ) {
+  lits.insert( lits.end(), clause, clause + size );
+  start.push_back( lits.size() );
+  lbd.push_back( clauseLbd );
+}
+
+// FNV-1a over the variable count, the literals of every clause and the
+// XORs and cardinality constraints given as such; recovered ones follow
+// from the clauses
+uint64_t formulaFingerprint ( Solver* solver ) {
+  uint64_t h = 14695981039346656037ULL;
+  uint64_t prime = 1099511628211ULL;
+  h = ( h ^ (uint64_t) solver->numVars ) * prime;
+  for ( int i = 0; i < solver->formula.size(); i++ ) {
+    Clause* c = &solver->formula[i];
+    for ( int j = 0; j < c->numVars; j++ )
+      h = ( h ^ (uint64_t) ( 2 * c->vars[j] + c->polarity[j] ) ) * prime;
+    h = ( h ^ 0xffffffffULL ) * prime; // clause separator
+  }
+  for ( int i = 0; i < solver->xors.size(); i++ ) {
+    Xor* x = &solver->xors[i];
+    if ( x->encoded )
+      continue;
+    for ( int j = 0; j < x->vars.size(); j++ )
+      h = ( h ^ (uint64_t) x->vars[j] ) * prime;
+    h = ( h ^ ( 0xfffffffeULL - x->rhs ) ) * prime;
+  }
+  for ( int i = 0; i < solver->cards.size(); i++ ) {
+    Card* c = &solver->cards[i];
+    if ( c->encoded )
+      continue;
+    for ( int j = 0; j < c->vars.size(); j++ )
+      h = ( h ^ (uint64_t) ( 2 * c->vars[j] + c->polarity[j] ) ) * prime;
+    h = ( h ^ ( 0x100000000ULL + c->bound ) ) * prime;
+  }
+  return h;
+}
+
+void putVarint ( std::vector<unsigned char>* out, uint64_t x ) {
+  while ( x >= 0x80 ) {
+    out->push_back( ( x & 0x7f ) | 0x80 );
+    x >>= 7;
+  }
+  out->push_back( x );
+}
+
+void putBytes ( std::vector<unsigned char>* out, const void* p, size_t n ) {
+  const unsigned char* bytes = (const unsigned char*) p;
+  out->insert( out->end(), bytes, bytes + n );
+}
+
+bool saveCheckpoint ( const Checkpoint* ckpt, const std::string& path ) {
+  std::vector<unsigned char> out;
+  int n = ckpt->numVars;
+  putBytes( &out, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE );
+  putBytes( &out, &ckpt->fingerprint, sizeof( uint64_t ) );
+  putVarint( &out, n );
+  putVarint( &out, ckpt->units.size() );
+  for ( int i = 0; i < ckpt->units.size(); i++ )
+    putVarint( &out, ckpt->units[i] );
+  for ( int v = 1; v < n + 1; v += 8 ) {
+    unsigned char bits = 0;
+    for ( int k = 0; k < 8 && v + k < n + 1; k++ ) {
+      if ( ckpt->phase[ v + k ] == VALUE_TRUE )
+        bits |= 1 << k;
+    }
+    out.push_back( bits );
+  }
+  if ( n > 0 )
+    putBytes( &out, &ckpt->activity[1], n * sizeof( float ) );
+  int numClauses = ckpt->lbd.size();
+  putVarint( &out, numClauses );
+  std::vector<int> sorted;
+  for ( int c = 0; c < numClauses; c++ ) {
+    sorted.assign( ckpt->lits.begin() + ckpt->start[c], ckpt->lits.begin() + ckpt->start[c + 1] );
+    std::sort( sorted.begin(), sorted.end() );
+    putVarint( &out, ckpt->lbd[c] );
+    putVarint( &out, sorted.size() );
+    int prev = 0;
+    for ( int k = 0; k < sorted.size(); k++ ) {
+      putVarint( &out, sorted[k] - prev );
+      prev = sorted[k];
+    }
+  }
+  std::string tmp = path + ".tmp";
+  std::ofstream file( tmp.c_str(), std::ios::binary | std::ios::trunc );
+  if ( !file.is_open() )
+    return false;
+  file.write( (const char*) &out[0], out.size() );
+  file.close();
+  if ( !file )
+    return false;
+  return rename( tmp.c_str(), path.c_str() ) == 0;
+}
+
+// Bounds checked reader over a loaded file
+struct CheckpointReader {
+  const unsigned char* p;
+  const unsigned char* end;
+  bool ok;
+  bool getVarint ( uint64_t* x ) {
+    *x = 0;
+    for ( int shift = 0; ok && shift < 64; shift += 7 ) {
+      if ( p == end )
+        break;
+      unsigned char byte = *p++;
+      *x |= (uint64_t) ( byte & 0x7f ) << shift;
+      if ( !( byte & 0x80 ) )
+        return true;
+    }
+    ok = false;
+    return false;
+  }
+  bool getBytes ( void* to, size_t n ) {
+    if ( !ok || end - p < n )
+      return ok = false;
+    memcpy( to, p, n );
+    p += n;
+    return true;
+  }
+};
+
+bool loadCheckpoint ( Checkpoint* ckpt, const std::string& path ) {
+  std::ifstream file( path.c_str(), std::ios::binary );
+  if ( !file.is_open() )
+    return false;
+  std::vector<unsigned char> data( ( std::istreambuf_iterator<char>( file ) ),
+      std::istreambuf_iterator<char>() );
+  CheckpointReader in = { data.data(), data.data() + data.size(), true };
+  char magic[ CHECKPOINT_MAGIC_SIZE ];
+  if ( !in.getBytes( magic, CHECKPOINT_MAGIC_SIZE ) || memcmp( magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE ) )
+    return false;
+  uint64_t x;
+  in.getBytes( &ckpt->fingerprint, sizeof( uint64_t ) );
+  if ( !in.getVarint( &x ) || x > data.size() * 8 )
+    return false; // every variable takes at least a phase bit
+  int n = ckpt->numVars = x;
+  int maxLit = 2 * n + 1;
+  if ( !in.getVarint( &x ) || x > data.size() )
+    return false;
+  ckpt->units.resize( x );
+  for ( int i = 0; i < ckpt->units.size(); i++ ) {
+    if ( !in.getVarint( &x ) || x < 2 || x > maxLit )
+      return false;
+    ckpt->units[i] = x;
+  }
+  ckpt->phase.assign( n + 1, VALUE_FALSE );
+  for ( int v = 1; v < n + 1; v += 8 ) {
+    unsigned char bits;
+    if ( !in.getBytes( &bits, 1 ) )
+      return false;
+    for ( int k = 0; k < 8 && v + k < n + 1; k++ )
+      ckpt->phase[ v + k ] = ( bits >> k ) & 1 ? VALUE_TRUE : VALUE_FALSE;
+  }
+  ckpt->activity.assign( n + 1, 0 );
+  if ( n > 0 && !in.getBytes( &ckpt->activity[1], n * sizeof( float ) ) )
+    return false;
+  uint64_t numClauses;
+  if ( !in.getVarint( &numClauses ) || numClauses > data.size() )
+    return false;
+  std::vector<int> clause;
+  for ( uint64_t c = 0; c < numClauses; c++ ) {
+    uint64_t lbd, size;
+    if ( !in.getVarint( &lbd ) || !in.getVarint( &size ) || size < 2 || size > n || lbd > size )
+      return false;
+    clause.clear();
+    uint64_t lit = 0;
+    for ( uint64_t k = 0; k < size; k++ ) {
+      if ( !in.getVarint( &x ) || ( k > 0 && x == 0 ) )
+        return false;
+      lit += x;
+      if ( lit < 2 || lit > maxLit )
+        return false;
+      clause.push_back( lit );
+    }
+    ckpt->addClause( &clause[0], size, lbd );
+  }
+  return in.ok && in.p == in.end;
+}
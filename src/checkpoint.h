@@ -0,0 +1,42 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "solver.h"
+
+// File layout: magic, fingerprint of the parsed formula, number of
+// variables, level 0 units, phases packed one bit per variable, activities
+// as floats relative to the bump increment, then learned clauses as LBD,
+// size and sorted literals. Counts and literals are LEB128 varints and each
+// clause stores the gaps between its sorted literals, so most take a byte.
+#define CHECKPOINT_MAGIC "SATCKPT1"
+#define CHECKPOINT_MAGIC_SIZE 8
+
+// Search state saved by a CDCL run, all literals encoded.
+struct Checkpoint {
+  uint64_t fingerprint;
+  int numVars;
+  std::vector<int> units;
+  std::vector<int8_t> phase; // per variable, VALUE_TRUE or VALUE_FALSE
+  std::vector<float> activity; // per variable, activity / activity increment
+  std::vector<int> lbd; // per clause
+  std::vector<int> lits; // literals of clause c in lits[start[c]..start[c + 1])
+  std::vector<int> start;
+  Checkpoint ();
+  void addClause ( const int* clause, int size, int lbd );
+};
+
+// Identifies the formula a checkpoint belongs to
+uint64_t formulaFingerprint ( Solver* solver );
+
+// Write to a temporary file renamed over path, so an interrupted write
+// leaves the previous checkpoint intact. Returns false on I/O errors.
+bool saveCheckpoint ( const Checkpoint* ckpt, const std::string& path );
+
+// Returns false and leaves ckpt unspecified if the file is missing,
+// truncated or not a checkpoint.
+bool loadCheckpoint ( Checkpoint* ckpt, const std::string& path );
+
+#endif
@@ -0,0 +1,40 @@
+#include "clausedb.h"
+#include <vector>
+
+ClauseDB::ClauseDB() {
+  wasted = 0;
+}
+
+ClauseRef ClauseDB::add ( const int* lits, int size, bool learned ) {
+  ClauseRef c = memory.size();
+  memory.push_back( size );
+  memory.push_back( learned ? CLAUSE_LEARNED : 0 );
+  memory.insert( memory.end(), lits, lits + size );
+  return c;
+}
+
+// mark a clause as removed, its space is reclaimed by the next collection
+void ClauseDB::remove ( ClauseRef c ) {
+  if ( deleted( c ) )
+    return;
+  memory[c + 1] |= CLAUSE_DELETED;
+  wasted += CLAUSE_HEADER + size( c );
+}
+
+// Copy a live clause into to and leave a forwarding reference behind, so
+// every later reference to the old clause maps to the same copy.
+ClauseRef ClauseDB::relocate ( ClauseRef c, ClauseDB* to ) {
+  if ( memory[c + 1] & CLAUSE_MOVED )
+    return memory[c + CLAUSE_HEADER];
+  ClauseRef moved = to->memory.size();
+  to->memory.insert( to->memory.end(), memory.begin() + c,
+      memory.begin() + c + CLAUSE_HEADER + size( c ) );
+  memory[c + 1] |= CLAUSE_MOVED;
+  memory[c + CLAUSE_HEADER] = moved;
+  return moved;
+}
+
+void ClauseDB::setLbd ( ClauseRef c, int lbd ) {
+  int flags = memory[c + 1] & ( ( 1 << CLAUSE_FLAG_BITS ) - 1 );
+  memory[c + 1] = flags | ( lbd << CLAUSE_FLAG_BITS );
+}
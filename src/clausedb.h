@@ -0,0 +1,42 @@
+#ifndef CLAUSEDB_H
+#define CLAUSEDB_H
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t ClauseRef;
+#define CLAUSE_NONE 0xffffffffu
+
+// Each clause is stored as [size][flags | lbd << CLAUSE_FLAG_BITS][lits...]
+#define CLAUSE_HEADER 2
+#define CLAUSE_LEARNED 1
+#define CLAUSE_DELETED 2
+#define CLAUSE_MOVED 4
+#define CLAUSE_DETACHED 8 // in no watch list, only a reason or conflict
+#define CLAUSE_FLAG_BITS 4
+
+// Arena holding all clauses of a CDCL search, addressed by word offset.
+// References stay valid until the next collection: remove only marks a
+// clause, and the search copies the live clauses into a fresh arena with
+// relocate once enough space is wasted, rewriting every reference it holds.
+class ClauseDB {
+  public:
+    std::vector<int> memory;
+    size_t wasted; // words held by removed clauses
+    ClauseDB ();
+    ClauseRef add ( const int* lits, int size, bool learned );
+    void remove ( ClauseRef c );
+    ClauseRef relocate ( ClauseRef c, ClauseDB* to );
+    size_t words () const { return memory.size(); }
+    int size ( ClauseRef c ) const { return memory[c]; }
+    int* lits ( ClauseRef c ) { return &memory[c + CLAUSE_HEADER]; }
+    bool learned ( ClauseRef c ) const { return memory[c + 1] & CLAUSE_LEARNED; }
+    bool deleted ( ClauseRef c ) const { return memory[c + 1] & CLAUSE_DELETED; }
+    bool detached ( ClauseRef c ) const { return memory[c + 1] & CLAUSE_DETACHED; }
+    void detach ( ClauseRef c ) { memory[c + 1] |= CLAUSE_DETACHED; }
+    int lbd ( ClauseRef c ) const { return memory[c + 1] >> CLAUSE_FLAG_BITS; }
+    void setLbd ( ClauseRef c, int lbd );
+};
+
+#endif
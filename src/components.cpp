@@ -0,0 +1,280 @@
+#include "components.h"
+#include "literal.h"
+#include "memusage.h"
+#include "perfcounters.h"
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+#include <memory>
+
+void UnionFind::init ( int n ) {
+  parent.resize( n + 1 );
+  size.assign( n + 1, 1 );
+  for ( int v = 0; v < n + 1; v++ )
+    parent[v] = v;
+}
+
+int UnionFind::find ( int v ) {
+  while ( parent[v] != v ) {
+    parent[v] = parent[ parent[v] ];
+    v = parent[v];
+  }
+  return v;
+}
+
+void UnionFind::unite ( int a, int b ) {
+  a = find( a );
+  b = find( b );
+  if ( a == b )
+    return;
+  if ( size[a] < size[b] )
+    std::swap( a, b );
+  parent[b] = a;
+  size[a] += size[b];
+}
+
+// Solve components from a shared index until none are left or one is
+// unsatisfiable. Each gets the part of the timeout not yet used. Hardware
+// counters only count the thread that opened them, so with countPhases each
+// thread opens its own for the parts it solves and reports it into the stats
+// of the last one.
+void solveComponentsFrom ( std::vector<CDCLSolver>* parts, std::vector<int>* order,
+    std::vector<int>* results, std::vector<SearchLimits>* limits,
+    std::atomic<int>* next, std::atomic<bool>* cancel, timePoint start, bool countPhases ) {
+  PerfCounters counters;
+  if ( countPhases )
+    counters.open();
+  int last = -1;
+  while ( !cancel->load() ) {
+    int i = ( *next )++;
+    if ( i >= order->size() )
+      break;
+    int k = ( *order )[i];
+    last = k;
+    SearchLimits* partLimits = &( *limits )[k];
+    if ( partLimits->timeout > 0 )
+      partLimits->timeout = std::max( partLimits->timeout - secondsSince( start ), 1e-9 );
+    ( *parts )[k].counters = counters.members ? &counters : nullptr;
+    ( *results )[k] = cdclSolve( &( *parts )[k], partLimits, 0 );
+    if ( ( *results )[k] == RESULT_UNSAT )
+      cancel->store( true );
+  }
+  if ( last >= 0 && counters.members )
+    counters.report( ( *parts )[ last ].stats );
+}
+
+int solveComponents ( CDCLSolver* solver, SearchLimits* limits, int threads, int verbose ) {
+  SolverStats* stats = solver->stats;
+  timePoint start = now();
+  limits->begin();
+  if ( !propagateRoot( solver ) ) {
+    stats->engine = "cdcl";
+    stats->result = "unsat";
+    stats->solveTime = secondsSince( start );
+    return RESULT_UNSAT;
+  }
+  // union the variables of every clause not satisfied at level 0
+  int n = solver->numVars;
+  ClauseDB& db = solver->db;
+  const std::vector<int8_t>& values = solver->values;
+  UnionFind sets;
+  sets.init( n );
+  std::vector<char> occurs( n + 1, 0 );
+  std::vector<ClauseRef> open;
+  for ( int i = 0; i < solver->clauses.size(); i++ ) {
+    ClauseRef c = solver->clauses[i];
+    int* lits = db.lits( c );
+    int first = 0;
+    bool satisfied = false;
+    for ( int k = 0; k < db.size( c ) && !satisfied; k++ )
+      satisfied = values[ lits[k] ] == VALUE_TRUE;
+    if ( satisfied )
+      continue;
+    open.push_back( c );
+    for ( int k = 0; k < db.size( c ); k++ ) {
+      if ( values[ lits[k] ] != VALUE_UNDEF )
+        continue;
+      int v = litVar( lits[k] );
+      occurs[v] = 1;
+      if ( first )
+        sets.unite( first, v );
+      else
+        first = v;
+    }
+  }
+  // and of every XOR, simplified by the level 0 assignment; elimination
+  // left none of them with fewer than two unassigned variables
+  std::vector<Xor> openXors;
+  for ( int i = 0; i < solver->xors.size(); i++ ) {
+    const Xor& x = solver->xors[i];
+    Xor simplified = { std::vector<unsigned int>(), x.rhs, x.encoded };
+    for ( int k = 0; k < x.vars.size(); k++ ) {
+      int8_t value = values[ 2 * x.vars[k] ];
+      if ( value == VALUE_TRUE )
+        simplified.rhs = !simplified.rhs;
+      else if ( value == VALUE_UNDEF )
+        simplified.vars.push_back( x.vars[k] );
+    }
+    if ( simplified.vars.empty() )
+      continue;
+    for ( int k = 0; k < simplified.vars.size(); k++ ) {
+      occurs[ simplified.vars[k] ] = 1;
+      sets.unite( simplified.vars[0], simplified.vars[k] );
+    }
+    openXors.push_back( simplified );
+  }
+  // and of every cardinality constraint, whose recovered clauses are not in
+  // the arena: true literals use up the bound, false ones drop out
+  std::vector<Card> openCards;
+  for ( int i = 0; i < solver->cards.size(); i++ ) {
+    const Card& c = solver->cards[i];
+    Card simplified = { std::vector<unsigned int>(), std::vector<bool>(), c.bound, false };
+    for ( int k = 0; k < c.vars.size(); k++ ) {
+      int8_t value = values[ 2 * c.vars[k] + c.polarity[k] ];
+      if ( value == VALUE_TRUE )
+        simplified.bound--;
+      else if ( value == VALUE_UNDEF ) {
+        simplified.vars.push_back( c.vars[k] );
+        simplified.polarity.push_back( c.polarity[k] );
+      }
+    }
+    if ( simplified.bound >= (int) simplified.vars.size() )
+      continue;
+    for ( int k = 0; k < simplified.vars.size(); k++ ) {
+      occurs[ simplified.vars[k] ] = 1;
+      sets.unite( simplified.vars[0], simplified.vars[k] );
+    }
+    openCards.push_back( simplified );
+  }
+  // renumber the variables of each component from 1
+  std::vector<int> componentOf( n + 1, -1 );
+  std::vector<int> localVar( n + 1, 0 );
+  std::vector< std::vector<int> > varsOf;
+  for ( int v = 1; v < n + 1; v++ ) {
+    if ( !occurs[v] )
+      continue;
+    int root = sets.find( v );
+    if ( componentOf[ root ] < 0 ) {
+      componentOf[ root ] = varsOf.size();
+      varsOf.push_back( std::vector<int>() );
+    }
+    componentOf[v] = componentOf[ root ];
+    varsOf[ componentOf[v] ].push_back( v );
+    localVar[v] = varsOf[ componentOf[v] ].size();
+  }
+  int count = varsOf.size();
+  if ( count < 2 )
+    return cdclSolve( solver, limits, verbose );
+
+  stats->components = count;
+  recordMemory( solver ); // the whole formula stays loaded beside the parts
+  std::vector<CDCLSolver> parts( count );
+  std::vector<SolverStats> partStats( count );
+  // each part is searched by one thread at a time, so it gets its own buffer
+  std::vector< std::unique_ptr<TraceBuffer> > partTraces( count );
+  for ( int k = 0; k < count; k++ ) {
+    parts[k].numVars = varsOf[k].size();
+    parts[k].sigma.assign( varsOf[k].size() + 1, 0 );
+    parts[k].stats = &partStats[k];
+    parts[k].walkInterval = solver->walkInterval;
+    parts[k].chronoThreshold = solver->chronoThreshold;
+    parts[k].memorySoftLimit = solver->memorySoftLimit;
+    if ( solver->trace ) {
+      partTraces[k].reset( new TraceBuffer( solver->trace->writer ) );
+      parts[k].trace = partTraces[k].get();
+    }
+  }
+  std::vector<unsigned int> clauseVars;
+  std::vector<bool> polarity;
+  for ( int i = 0; i < open.size(); i++ ) {
+    int* lits = db.lits( open[i] );
+    clauseVars.clear();
+    polarity.clear();
+    int component = -1;
+    for ( int k = 0; k < db.size( open[i] ); k++ ) {
+      if ( values[ lits[k] ] != VALUE_UNDEF )
+        continue;
+      component = componentOf[ litVar( lits[k] ) ];
+      clauseVars.push_back( localVar[ litVar( lits[k] ) ] );
+      polarity.push_back( litSign( lits[k] ) );
+    }
+    // after propagation without a conflict, open clauses have two or more
+    // unassigned literals
+    CDCLSolver* part = &parts[ component ];
+    part->formula.push_back( Clause( &clauseVars, &polarity, clauseVars.size(), part->formula.size() ) );
+  }
+  for ( int i = 0; i < openXors.size(); i++ ) {
+    Xor& x = openXors[i];
+    int component = componentOf[ x.vars[0] ];
+    for ( int k = 0; k < x.vars.size(); k++ )
+      x.vars[k] = localVar[ x.vars[k] ];
+    parts[ component ].xors.push_back( x );
+  }
+  for ( int i = 0; i < openCards.size(); i++ ) {
+    Card& c = openCards[i];
+    int component = componentOf[ c.vars[0] ];
+    for ( int k = 0; k < c.vars.size(); k++ )
+      c.vars[k] = localVar[ c.vars[k] ];
+    parts[ component ].cards.push_back( c );
+  }
+  for ( int k = 0; k < count; k++ )
+    parts[k].numClauses = parts[k].formula.size();
+  if ( verbose )
+    std::cerr << "c " << count << " independent components\n";
+
+  // smallest first, so an unsatisfiable part is likely found early
+  std::vector<int> order( count );
+  for ( int k = 0; k < count; k++ )
+    order[k] = k;
+  std::sort( order.begin(), order.end(), [&parts]( int a, int b ) {
+    return parts[a].numClauses < parts[b].numClauses;
+  } );
+  std::atomic<bool> cancel( false );
+  std::vector<SearchLimits> partLimits( count, *limits );
+  for ( int k = 0; k < count; k++ )
+    partLimits[k].cancel = &cancel;
+  std::vector<int> results( count, RESULT_UNKNOWN );
+  std::atomic<int> next( 0 );
+  bool countPhases = solver->counters != nullptr;
+  int extra = std::min( threads, count ) - 1;
+  std::vector<std::thread> pool;
+  for ( int t = 0; t < extra; t++ )
+    pool.push_back( std::thread( solveComponentsFrom, &parts, &order, &results, &partLimits, &next, &cancel, start, countPhases ) );
+  solveComponentsFrom( &parts, &order, &results, &partLimits, &next, &cancel, start, countPhases );
+  for ( int t = 0; t < pool.size(); t++ )
+    pool[t].join();
+
+  int result = RESULT_SAT;
+  const char* reason = nullptr;
+  for ( int k = 0; k < count; k++ ) {
+    stats->add( &partStats[k] );
+    if ( results[k] == RESULT_UNSAT )
+      result = RESULT_UNSAT;
+    else if ( results[k] == RESULT_UNKNOWN && result != RESULT_UNSAT ) {
+      result = RESULT_UNKNOWN;
+      if ( !reason || ( partLimits[k].reason && strcmp( partLimits[k].reason, "cancelled" ) ) )
+        reason = partLimits[k].reason;
+    }
+  }
+  stats->engine = "cdcl";
+  stats->solveTime = secondsSince( start );
+  if ( result == RESULT_SAT ) {
+    for ( int v = 1; v < n + 1; v++ ) {
+      if ( values[ 2 * v ] != VALUE_UNDEF )
+        solver->sigma[v] = values[ 2 * v ];
+      else if ( occurs[v] )
+        solver->sigma[v] = parts[ componentOf[v] ].sigma[ localVar[v] ];
+      else
+        solver->sigma[v] = VALUE_TRUE; // in no open clause, either value works
+    }
+    stats->result = "sat";
+  } else if ( result == RESULT_UNSAT ) {
+    stats->result = "unsat";
+  } else {
+    limits->reason = reason;
+    stats->stopReason = reason ? reason : "none";
+  }
+  return result;
+}
@@ -0,0 +1,25 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <vector>
+#include "cdcl.h"
+#include "budget.h"
+
+// Disjoint sets over variables 1..n with union by size and path halving
+struct UnionFind {
+  std::vector<int> parent;
+  std::vector<int> size;
+  void init ( int n );
+  int find ( int v );
+  void unite ( int a, int b );
+};
+
+// Propagate the level 0 units, split the remaining clauses into
+// variable-connected components and solve each with its own CDCL search on
+// up to threads threads, smallest component first. The first unsatisfiable
+// component cancels the others. On RESULT_SAT the combined model is left
+// in sigma; statistics of all components are summed into solver->stats.
+// Counter budgets apply to each component, the timeout to the whole solve.
+int solveComponents ( CDCLSolver* solver, SearchLimits* limits, int threads, int verbose );
+
+#endif
@@ -0,0 +1,331 @@
+#include "daemon.h"
+#include "cdcl.h"
+#include "parser.h"
+#include "input.h"
+#include <iostream>
+#include <sstream>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// One client connection, or stdin and stdout. Jobs hold a reference so the
+// socket stays open until the last of its results has been sent.
+struct Channel {
+  int in;
+  int out;
+  bool ownsFds;
+  std::mutex writeLock; // results of concurrent jobs are written whole
+  Channel ( int inFd, int outFd, bool owns ) : in( inFd ), out( outFd ), ownsFds( owns ) {}
+  ~Channel () {
+    if ( ownsFds )
+      close( in );
+  }
+  void send ( const std::string& text );
+};
+
+void Channel::send ( const std::string& text ) {
+  std::lock_guard<std::mutex> guard( writeLock );
+  size_t done = 0;
+  while ( done < text.size() ) {
+    ssize_t n = write( out, text.data() + done, text.size() - done );
+    if ( n < 0 && errno == EINTR )
+      continue;
+    if ( n <= 0 )
+      return; // client went away, drop the result
+    done += n;
+  }
+}
+
+// Buffered reads of header lines and exact size payloads from a file
+// descriptor
+struct ChannelReader {
+  int fd;
+  char buffer[ 1 << 16 ];
+  size_t pos;
+  size_t end;
+  ChannelReader ( int inFd ) : fd( inFd ), pos( 0 ), end( 0 ) {}
+  bool fill ();
+  bool readLine ( std::string* line );
+  bool readBytes ( std::string* out, size_t n );
+};
+
+bool ChannelReader::fill () {
+  while ( true ) {
+    ssize_t n = read( fd, buffer, sizeof( buffer ) );
+    if ( n < 0 && errno == EINTR ) {
+      if ( interruptRequested.load() )
+        return false;
+      continue;
+    }
+    if ( n <= 0 )
+      return false;
+    pos = 0;
+    end = n;
+    return true;
+  }
+}
+
+bool ChannelReader::readLine ( std::string* line ) {
+  line->clear();
+  while ( true ) {
+    if ( pos == end && !fill() )
+      return !line->empty();
+    char* start = buffer + pos;
+    char* newline = (char*) memchr( start, '\n', end - pos );
+    if ( newline ) {
+      line->append( start, newline - start );
+      pos += newline - start + 1;
+      return true;
+    }
+    line->append( start, end - pos );
+    pos = end;
+  }
+}
+
+bool ChannelReader::readBytes ( std::string* out, size_t n ) {
+  out->clear();
+  out->reserve( n );
+  while ( out->size() < n ) {
+    if ( pos == end && !fill() )
+      return false;
+    size_t take = std::min( n - out->size(), end - pos );
+    out->append( buffer + pos, take );
+    pos += take;
+  }
+  return true;
+}
+
+struct DaemonJob {
+  std::shared_ptr<Channel> channel;
+  std::string id;
+  std::string dimacs; // payload of a solve request
+  std::string path; // input of a file request
+  SearchLimits limits;
+  bool model;
+};
+
+// Jobs waiting for a worker. Once closed, workers drain the queue and stop.
+struct JobQueue {
+  std::deque<DaemonJob> jobs;
+  std::mutex lock;
+  std::condition_variable ready;
+  bool closed;
+  JobQueue () : closed( false ) {}
+  void push ( DaemonJob* job );
+  bool pop ( DaemonJob* job );
+  void close ();
+};
+
+void JobQueue::push ( DaemonJob* job ) {
+  {
+    std::lock_guard<std::mutex> guard( lock );
+    jobs.push_back( DaemonJob() );
+    std::swap( jobs.back(), *job );
+  }
+  ready.notify_one();
+}
+
+bool JobQueue::pop ( DaemonJob* job ) {
+  std::unique_lock<std::mutex> guard( lock );
+  ready.wait( guard, [this] { return closed || !jobs.empty(); } );
+  if ( jobs.empty() )
+    return false;
+  std::swap( *job, jobs.front() );
+  jobs.pop_front();
+  return true;
+}
+
+void JobQueue::close () {
+  {
+    std::lock_guard<std::mutex> guard( lock );
+    closed = true;
+  }
+  ready.notify_all();
+}
+
+struct Daemon {
+  DaemonOptions* options;
+  JobQueue queue;
+  std::atomic<bool> stopping; // quit received
+  Daemon ( DaemonOptions* o ) : options( o ), stopping( false ) {}
+};
+
+// Solve one job with the worker's solver and send its result
+void runJob ( Daemon* daemon, CDCLSolver* solver, DaemonJob* job ) {
+  SolverStats stats;
+  solver->stats = &stats;
+  solver->walkInterval = daemon->options->walkInterval;
+  solver->chronoThreshold = daemon->options->chronoThreshold;
+  solver->memorySoftLimit = (size_t) daemon->options->memorySoftMB << 20;
+  timePoint start = now();
+  bool parsed;
+  if ( !job->path.empty() ) {
+    InputFile file;
+    if ( job->path == "-" || !file.open( job->path ) ) {
+      job->channel->send( "result " + job->id + " error cannot open " + job->path + "\n" );
+      return;
+    }
+    parsed = parseDimacs( solver, file ) && file.error().empty();
+  } else {
+    std::istringstream in( job->dimacs );
+    parsed = parseDimacs( solver, in );
+    std::string().swap( job->dimacs );
+  }
+  if ( !parsed ) {
+    job->channel->send( "result " + job->id + " error invalid DIMACS\n" );
+    return;
+  }
+  int result = cdclSolve( solver, &job->limits, 0 );
+  std::ostringstream out;
+  out << "result " << job->id << " "
+      << ( result == RESULT_SAT ? "sat" : result == RESULT_UNSAT ? "unsat" : "unknown" )
+      << " time=" << secondsSince( start ) << " conflicts=" << stats.conflicts;
+  if ( result == RESULT_UNKNOWN && job->limits.reason )
+    out << " stop=" << job->limits.reason;
+  out << "\n";
+  if ( result == RESULT_SAT && job->model ) {
+    out << "v";
+    for ( int i = 1; i < solver->numVars + 1; i++ )
+      out << " " << ( solver->sigma[i] < 0 ? -i : i );
+    out << " 0\n";
+  }
+  job->channel->send( out.str() );
+}
+
+void workerLoop ( Daemon* daemon ) {
+  CDCLSolver solver;
+  DaemonJob job;
+  while ( daemon->queue.pop( &job ) ) {
+    runJob( daemon, &solver, &job );
+    job.channel.reset();
+  }
+}
+
+// Apply key=value options of a request to its job. Returns false on an
+// unknown key or malformed value.
+bool parseJobOptions ( std::istringstream* header, DaemonJob* job ) {
+  std::string option;
+  while ( *header >> option ) {
+    size_t eq = option.find( '=' );
+    if ( eq == std::string::npos )
+      return false;
+    std::string key = option.substr( 0, eq );
+    std::istringstream value( option.substr( eq + 1 ) );
+    bool ok;
+    if ( key == "time" )
+      ok = !!( value >> job->limits.timeout );
+    else if ( key == "conflicts" )
+      ok = !!( value >> job->limits.maxConflicts );
+    else if ( key == "propagations" )
+      ok = !!( value >> job->limits.maxPropagations );
+    else if ( key == "decisions" )
+      ok = !!( value >> job->limits.maxDecisions );
+    else if ( key == "model" )
+      ok = !!( value >> job->model );
+    else
+      ok = false;
+    if ( !ok )
+      return false;
+  }
+  return true;
+}
+
+// Read requests from a channel until it ends or quit arrives
+void serveChannel ( Daemon* daemon, std::shared_ptr<Channel> channel ) {
+  ChannelReader reader( channel->in );
+  std::string line;
+  while ( !daemon->stopping.load() && reader.readLine( &line ) ) {
+    std::istringstream header( line );
+    std::string command;
+    if ( !( header >> command ) )
+      continue;
+    if ( command == "quit" ) {
+      daemon->stopping.store( true );
+      break;
+    }
+    DaemonJob job;
+    job.channel = channel;
+    job.limits = daemon->options->limits;
+    job.model = false;
+    size_t bytes = 0;
+    bool valid = false;
+    if ( command == "solve" )
+      valid = !!( header >> job.id >> bytes );
+    else if ( command == "file" )
+      valid = !!( header >> job.id >> job.path );
+    if ( command == "solve" && valid && bytes > DAEMON_MAX_JOB_BYTES ) {
+      channel->send( "result " + job.id + " error payload too large\n" );
+      break; // the payload cannot be skipped safely, drop the connection
+    }
+    if ( command == "solve" && valid && !reader.readBytes( &job.dimacs, bytes ) )
+      break;
+    if ( !valid || !parseJobOptions( &header, &job ) ) {
+      channel->send( "result " + ( job.id.empty() ? std::string( "-" ) : job.id ) + " error bad request\n" );
+      continue;
+    }
+    daemon->queue.push( &job );
+  }
+}
+
+// Accept connections until quit or an interrupt, one reader thread each
+int acceptLoop ( Daemon* daemon, const std::string& path ) {
+  int listener = socket( AF_UNIX, SOCK_STREAM, 0 );
+  struct sockaddr_un addr;
+  memset( &addr, 0, sizeof( addr ) );
+  addr.sun_family = AF_UNIX;
+  if ( listener < 0 || path.size() >= sizeof( addr.sun_path ) ) {
+    std::cerr << "c cannot create socket " << path << "\n";
+    return -1;
+  }
+  strcpy( addr.sun_path, path.c_str() );
+  unlink( path.c_str() );
+  if ( bind( listener, (struct sockaddr*) &addr, sizeof( addr ) ) < 0 || listen( listener, 64 ) < 0 ) {
+    std::cerr << "c cannot listen on " << path << ": " << strerror( errno ) << "\n";
+    close( listener );
+    return -1;
+  }
+  struct pollfd pfd = { listener, POLLIN, 0 };
+  while ( !daemon->stopping.load() && !interruptRequested.load() ) {
+    if ( poll( &pfd, 1, DAEMON_POLL_MS ) <= 0 )
+      continue;
+    int fd = accept( listener, NULL, NULL );
+    if ( fd < 0 )
+      continue;
+    std::shared_ptr<Channel> channel( new Channel( fd, fd, true ) );
+    std::thread( serveChannel, daemon, channel ).detach();
+  }
+  close( listener );
+  unlink( path.c_str() );
+  return 0;
+}
+
+int runDaemon ( DaemonOptions* options ) {
+  signal( SIGPIPE, SIG_IGN );
+  // never freed: connection readers may still be blocked in read when the
+  // server returns
+  Daemon* daemon = new Daemon( options );
+  std::vector<std::thread> workers;
+  int count = options->workers > 0 ? options->workers : 1;
+  for ( int i = 0; i < count; i++ )
+    workers.push_back( std::thread( workerLoop, daemon ) );
+  int status = 0;
+  if ( options->socketPath == "-" )
+    serveChannel( daemon, std::make_shared<Channel>( 0, 1, false ) );
+  else
+    status = acceptLoop( daemon, options->socketPath );
+  daemon->queue.close();
+  for ( int i = 0; i < workers.size(); i++ )
+    workers[i].join();
+  return status;
+}
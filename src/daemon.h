@@ -0,0 +1,41 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <string>
+#include "budget.h"
+
+// Server mode: jobs arrive on a Unix domain socket, or on stdin with
+// results on stdout, and are solved with CDCL by a pool of workers. Each
+// worker keeps one solver whose arena, watch lists and heap are reused by
+// every job it runs.
+//
+// Requests are one header line, optionally followed by a payload:
+//   solve ID BYTES [key=value ...]   then BYTES bytes of DIMACS
+//   file ID PATH [key=value ...]     DIMACS read by the worker from PATH
+//   quit                             finish queued jobs and exit
+// with keys time, conflicts, propagations, decisions (per job budgets, the
+// command line limits are the defaults) and model=1 to return the model.
+// IDs are chosen by the client and contain no spaces. Each job answers with
+//   result ID sat|unsat|unknown time=SECONDS conflicts=N [stop=REASON]
+//   v LITERALS 0                     after sat with model=1
+// or "result ID error MESSAGE". Results of one channel are sent in order of
+// completion, not of submission.
+
+// largest accepted DIMACS payload
+#define DAEMON_MAX_JOB_BYTES ( 256 << 20 )
+// how often, in milliseconds, the accept loop checks for a shutdown
+#define DAEMON_POLL_MS 200
+
+struct DaemonOptions {
+  std::string socketPath; // "-" for stdin and stdout
+  int workers;
+  SearchLimits limits; // default per job budgets
+  int walkInterval;
+  int chronoThreshold;
+  long memorySoftMB; // per worker, 0 for no limit
+};
+
+// Serve until quit, end of stdin or an interrupt. Returns the exit status.
+int runDaemon ( DaemonOptions* options );
+
+#endif
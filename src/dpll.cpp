@@ -1,15 +1,16 @@
 #include "solver.h"
 #include <vector>
 #include "dpll.h"
+#include "literal.h"
 #include <iostream>
 #include <stdlib.h>
 #include <stack>
+#include <algorithm>
 
 using namespace std;
 
 DPLLSolver::DPLLSolver( std::vector<Clause> f, std::vector<int> s, int numc, int numv, std::vector<int> activec )
-  : Solver ( f, s, numc, numv ) {
-  activeClauses = activec;
+  : Solver ( std::move( f ), std::move( s ), numc, numv ), activeClauses( std::move( activec ) ) {
 
 }
 
@@ -18,25 +19,6 @@ DPLLSolver::DPLLSolver () : Solver() {
   std::stack<decision> decisionStack;
 }
 
-std::vector<int> DPLLSolver::getSingletons() {
-  std::vector<int> singletons;
-  int numv;
-  int unassigned;
-  // check each clause:
-  for( int i = 0; i <  numClauses; i++ ) {
-    Clause current = formula[i];
-    numv = current.numVars;
-    unassigned = numv;
-    for ( int j = 0; j < numv; j++ ) {
-      if ( sigma[current.vars[j]] != 0 ) unassigned--;
-    }
-    if( unassigned == 1 ) {
-      singletons.push_back( i );
-    }
-  }
-  return singletons;
-}
-
 // debugging utility
 template <typename T>
 void dump_stack(std::stack<T>* stack) {
@@ -60,198 +42,381 @@ void dump_vec(std::vector<T>* vec) {
   std::cout << "\n";
 }
 
-void pickClause ( DPLLSolver* solver, Clause* c ) {
-  while ( !(solver->activeClauses).empty() ) {
-    int clauseIndex = (solver->activeClauses).back();
-    //bool verb = (clauseIndex == 0);
-    (solver->activeClauses).pop_back();
-    *c = (solver->formula)[clauseIndex];
-    if ( ( c->watchedLits.snd == 0 ) && ( solver->sigma[ abs( c->watchedLits.fst ) ] == 0 ) )
-      return; //special case based on enco1ding of watched lits
-    int wl1 = c->watchedLits.fst;
-    int wl2 = c->watchedLits.snd;
-    // TODO: this guard is super ugly 
-    if ( ( ( solver->sigma[abs( wl1 ) ] * wl1 ) > 0 ) || ( ( solver->sigma[abs( wl2 ) ] * wl2 ) > 0 ) )  {
-      continue; // clause is true
-    }
-    else if ( (solver->sigma)[ abs( wl1 ) ] == 0 ) {
-      if ( (solver->sigma)[ abs( wl2 ) ] == 0 )
-        continue; // not a unit clause
-      else {
-        if ( (*solver).moveWatchedLit(2, clauseIndex) )
-          continue;
-        else return;
-      }
-    }
-    else { // sigma(c.w_1) != 0
-      if ( (*solver).moveWatchedLit(1, clauseIndex) ) {
-        (solver->activeClauses).push_back(clauseIndex);
+// Weight of a clause shrunk to the given size: new binaries constrain the
+// formula most, longer clauses count for progressively less.
+inline double sizeWeight ( int size ) {
+  switch ( size ) {
+    case 0:
+    case 1: return 0;
+    case 2: return 1;
+    case 3: return 0.2;
+    case 4: return 0.05;
+    case 5: return 0.01;
+    default: return 0.002;
+  }
+}
+
+// Make lit true and update the clause counters. Clauses that become unit are
+// queued for propagate, an empty clause sets the conflict flag.
+void assign ( Lookahead* la, int lit ) {
+  int neg = litNeg( lit );
+  la->values[ lit ] = VALUE_TRUE;
+  la->values[ neg ] = VALUE_FALSE;
+  la->trail.push_back( lit );
+  std::vector<int>& pos = la->occurs[ lit ];
+  for ( int i = 0; i < pos.size(); i++ )
+    la->satisfied[ pos[i] ]++;
+  std::vector<int>& shrunk = la->occurs[ neg ];
+  for ( int i = 0; i < shrunk.size(); i++ ) {
+    int c = shrunk[i];
+    int size = --la->size[ c ];
+    if ( la->satisfied[ c ] > 0 )
+      continue;
+    la->reduction += sizeWeight( size );
+    if ( size == 1 )
+      la->units.push_back( c );
+    else if ( size == 0 )
+      la->conflict = true;
+  }
+}
+
+// Undo every assignment made after the trail had length mark
+void unassignTo ( Lookahead* la, int mark ) {
+  while ( la->trail.size() > mark ) {
+    int lit = la->trail.back();
+    int neg = litNeg( lit );
+    la->trail.pop_back();
+    std::vector<int>& pos = la->occurs[ lit ];
+    for ( int i = 0; i < pos.size(); i++ )
+      la->satisfied[ pos[i] ]--;
+    std::vector<int>& shrunk = la->occurs[ neg ];
+    for ( int i = 0; i < shrunk.size(); i++ )
+      la->size[ shrunk[i] ]++;
+    la->values[ lit ] = VALUE_UNDEF;
+    la->values[ neg ] = VALUE_UNDEF;
+  }
+  if ( la->qhead > mark )
+    la->qhead = mark;
+  la->units.clear();
+  la->conflict = false;
+}
+
+// Unit propagation over the queued unit clauses and the local implications
+// of newly assigned literals. Returns false on a conflict.
+bool propagate ( Lookahead* la, SolverStats* stats ) {
+  while ( !la->conflict ) {
+    if ( !la->units.empty() ) {
+      int c = la->units.back();
+      la->units.pop_back();
+      if ( la->satisfied[ c ] > 0 )
         continue;
-      }
-      else {
-        if ( ( wl2 != 0 ) && ( (solver->sigma)[ abs( wl2 ) ] == 0 ) ) {
-          return; // unit clause
+      int unit = -1;
+      for ( int i = la->start[c]; i < la->start[c + 1]; i++ ) {
+        if ( la->values[ la->lits[i] ] == VALUE_UNDEF ) {
+          unit = la->lits[i];
+          break;
         }
-        else {
-          (solver->activeClauses).clear();
-          (*c) = Clause ( clauseIndex ); //TODO: this?
-          return;
+      }
+      if ( unit < 0 ) {
+        la->conflict = true;
+        break;
+      }
+      assign( la, unit );
+      stats->propagations++;
+    } else if ( la->qhead < la->trail.size() ) {
+      std::vector<int>& implied = la->implications[ la->trail[ la->qhead++ ] ];
+      for ( int i = 0; i < implied.size() && !la->conflict; i++ ) {
+        int value = la->values[ implied[i] ];
+        if ( value == VALUE_FALSE )
+          la->conflict = true;
+        else if ( value == VALUE_UNDEF ) {
+          assign( la, implied[i] );
+          stats->propagations++;
         }
       }
+    } else {
+      break;
     }
   }
+  if ( la->conflict ) {
+    la->units.clear();
+    return false;
+  }
+  return true;
 }
 
-decision unitRule ( Clause* clause, std::vector<int>* sigma, std::vector<int>* sigmaStack ) {
-  int numv = clause->numVars;
-  int unitLit, var, unitIndex;
-  bool polarity;
-  int numUnits = 0;
-  decision d;
-  d.var = -1;
-  d.assignment = 0;
-  for ( int i = 0; i < numv; i++ ) {
-    var = clause->vars[i];
-    polarity = clause->polarity[i];
-    int value = (*sigma)[var];
-    if ( ( ( (*sigma)[var] == 1 ) ^ polarity ) && ( (*sigma)[var] != 0 ) ) { // something already evaluates to true, no unit rule
-      return d;
+// Record the local binary clause (-a or -b) found by double lookahead
+void learnLocal ( Lookahead* la, int a, int b ) {
+  la->implications[ a ].push_back( litNeg( b ) );
+  la->implications[ b ].push_back( litNeg( a ) );
+  la->learnedFrom.push_back( a );
+  la->learnedFrom.push_back( b );
+}
+
+// Rank the free variables of unsatisfied clauses by how much they occur in
+// short clauses and return the best ones, best first
+void preselect ( Lookahead* la, std::vector<int>* candidates ) {
+  std::vector<double>& h = la->heuristic;
+  std::vector<int> free;
+  for ( int v = 1; v < la->numVars + 1; v++ ) {
+    if ( la->values[ 2 * v ] != VALUE_UNDEF )
+      continue;
+    double pos = 0;
+    double neg = 0;
+    for ( int i = 0; i < la->occurs[ 2 * v ].size(); i++ ) {
+      int c = la->occurs[ 2 * v ][i];
+      if ( la->satisfied[c] == 0 ) pos += sizeWeight( la->size[c] );
     }
-    if ( (*sigma)[var] == 0 ) {
-      unitIndex = i;
-      numUnits++;
-      unitLit = var;
+    for ( int i = 0; i < la->occurs[ 2 * v + 1 ].size(); i++ ) {
+      int c = la->occurs[ 2 * v + 1 ][i];
+      if ( la->satisfied[c] == 0 ) neg += sizeWeight( la->size[c] );
     }
+    if ( pos + neg == 0 )
+      continue; // only in satisfied clauses
+    h[v] = 1024 * pos * neg + pos + neg;
+    free.push_back( v );
   }
-  if ( numUnits == 1 ) {
-    d.var = unitLit;
-    d.assignment = (clause->polarity[unitIndex]) ? -1 : 1;
-    return d;
-  }
-  else if ( numUnits < 1 )
-    return d;
-  else {
-    return d;
-  }
+  int count = free.size() * LOOKAHEAD_CANDIDATE_PERCENT / 100;
+  if ( count < LOOKAHEAD_MIN_CANDIDATES )
+    count = LOOKAHEAD_MIN_CANDIDATES;
+  if ( count > free.size() )
+    count = free.size();
+  std::partial_sort( free.begin(), free.begin() + count, free.end(), [&h]( int a, int b ) {
+    return h[a] > h[b];
+  } );
+  candidates->assign( free.begin(), free.begin() + count );
 }
 
-
-void unitPropagate ( DPLLSolver* solver, bool* conflict ) {
-  while ( true ) {
-    Clause c;
-    pickClause ( solver, &c );
-    if ( c.numVars == 0 ) {
-      //std::cout << "NULL\n";
-      return; // indicates null clause
-    }
-    else if ( c.conflictIndex >= 0 ) {
-      (*conflict) = true;
-      return;
+// Look ahead on the candidates below the current assignment of lit. A
+// candidate literal that fails there is false under lit, which is kept as a
+// local binary. Returns false if lit itself fails.
+bool doubleLookahead ( Lookahead* la, int lit, std::vector<int>* candidates, SolverStats* stats ) {
+  int limit = std::min( (int) candidates->size(), DL_MAX_CANDIDATES );
+  for ( int i = 0; i < limit; i++ ) {
+    int v = (*candidates)[i];
+    for ( int l = 2 * v; l <= 2 * v + 1; l++ ) {
+      if ( la->values[ l ] != VALUE_UNDEF )
+        continue;
+      int mark = la->trail.size();
+      assign( la, l );
+      bool ok = propagate( la, stats );
+      unassignTo( la, mark );
+      if ( ok )
+        continue;
+      stats->failedLiterals++;
+      learnLocal( la, lit, l );
+      assign( la, litNeg( l ) );
+      if ( !propagate( la, stats ) )
+        return false;
     }
-    else {
-      // no conflict! apply unit rule
-      decision d = unitRule( &c, &(solver->sigma), &(solver->sigmaStack) );
-      // expand active clauses:
-      if ( d.var <= 0 ) continue;
-      (solver->sigma)[d.var] = d.assignment;
-      (solver->sigmaStack).push_back( d.var );
-      for ( int i = 0; i < solver->numClauses; i++ ) {
-        Clause c = solver->formula[i];
-        if ( c.hasLit( d.var ) ) {
-          (solver->activeClauses).push_back( i );
+  }
+  return true;
+}
+
+// Look ahead on both literals of every candidate, scoring each by the clause
+// size reduction it causes. Failed literals are forced false at this node and
+// the round repeats until none is found. Returns false if the node fails.
+bool lookaheadPhase ( Lookahead* la, std::vector<int>* candidates, SolverStats* stats ) {
+  bool changed = true;
+  while ( changed ) {
+    changed = false;
+    preselect( la, candidates );
+    for ( int i = 0; i < candidates->size(); i++ ) {
+      int v = (*candidates)[i];
+      for ( int lit = 2 * v; lit <= 2 * v + 1; lit++ ) {
+        if ( la->values[ lit ] != VALUE_UNDEF )
+          continue;
+        int mark = la->trail.size();
+        la->reduction = 0;
+        assign( la, lit );
+        bool ok = propagate( la, stats );
+        double score = la->reduction;
+        if ( ok && score > la->dlTrigger ) {
+          la->dlTrigger = score;
+          ok = doubleLookahead( la, lit, candidates, stats );
         }
+        unassignTo( la, mark );
+        la->lookScore[ lit ] = score;
+        if ( ok )
+          continue;
+        stats->failedLiterals++;
+        assign( la, litNeg( lit ) );
+        if ( !propagate( la, stats ) )
+          return false;
+        changed = true;
       }
     }
   }
+  return true;
 }
 
-// Utility function for running manual tests of the sub-algorithms
-void testWrapper ( DPLLSolver solver ) {
-  solver.activeClauses = solver.getSingletons();
-  bool con;
-  unitPropagate ( &solver, &con );
-}
+// A node of the lookahead search with a branch left to try or being tried
+struct LookaheadNode {
+  int learnedMark; // local binaries from here on were learned at or below it
+  int mark; // trail size before its branch literal
+  int branch[2];
+  int next; // branches tried so far
+};
 
-//  propagate more
-decision makeDecision ( DPLLSolver* solver ) {
-  decision d;
-  for ( int i = 1; i < solver->numVars + 1; i++)  {
-    if ( (solver->sigma)[i] == 0 ) {
-      d.var = i;
-      d.assignment = -1;
-      return d;
-    }
+// Drop the local binaries learned since mark
+void dropLearned ( Lookahead* la, int mark ) {
+  while ( la->learnedFrom.size() > mark ) {
+    la->implications[ la->learnedFrom.back() ].pop_back();
+    la->learnedFrom.pop_back();
   }
-  std::cout << "Error: exhausted possible decisions\n";
-  return { -1, 0 };
 }
 
-
-void dpllEval ( DPLLSolver solver, int timeout ) {
-  solver.activeClauses = solver.getSingletons();
-  bool conflict;
-  bool shouldOverride = false;
-  time_t endTime = time( NULL ) + timeout;
-  //Main loop: go until timeout
-  while( time( NULL ) <= endTime ) {
-    conflict = false;
-    // unit propagate
-    unitPropagate ( &solver, &conflict );
-    shouldOverride = false;
-    // If no conflicts, respond
-    if ( !conflict ) {
-      if ( solver.sigmaStack.size() == solver.numVars && ( solver.activeClauses.size() == 0 ) ) {
-        // All assigned
-        std::cout << "sat";
-        std::cout << "lit  val \n";
-        for ( int i = 1; i < solver.numVars + 1; i++) {
-          std::cout << " " << i << "    " << ( solver.sigma[i] == 1 ) << "\n";
-        }
-
-        return;
-      } else {
-        // make decision
-        decision d = makeDecision ( &solver );
-        (solver.sigma)[d.var] = d.assignment;
-        solver.sigmaStack.push_back(d.var);
-        solver.decisionStack.push(d);
-        // expand active clauses:
-        for ( int i = 0; i < solver.numClauses; i++ ) {
-          Clause c = solver.formula[i];
-          if ( c.hasLit( d.var ) ) {
-            solver.activeClauses.push_back( i );
-          }
+// Depth first lookahead search below the current assignment. The nodes on
+// the path to the current one are kept in a vector rather than on the call
+// stack, so the depth is not limited by the thread's stack size.
+// Returns 1 if satisfiable, 0 if unsatisfiable, -1 if a budget ran out.
+int lookaheadSearch ( Lookahead* la, SearchLimits* limits, SolverStats* stats ) {
+  std::vector<LookaheadNode> nodes;
+  std::vector<int> candidates;
+  while ( true ) {
+    // a node at the current assignment, which propagated without conflict
+    if ( limits->exhausted( stats ) )
+      return -1;
+    la->dlTrigger *= DL_TRIGGER_DECAY;
+    LookaheadNode node;
+    node.learnedMark = la->learnedFrom.size();
+    node.next = 0;
+    if ( !lookaheadPhase( la, &candidates, stats ) ) {
+      stats->conflicts++;
+      dropLearned( la, node.learnedMark );
+    } else {
+      // branch on the candidate whose two lookaheads both reduce the most
+      int best = -1;
+      double bestScore = -1;
+      for ( int i = 0; i < candidates.size(); i++ ) {
+        int v = candidates[i];
+        if ( la->values[ 2 * v ] != VALUE_UNDEF )
+          continue;
+        double pos = la->lookScore[ 2 * v ];
+        double neg = la->lookScore[ 2 * v + 1 ];
+        double score = 1024 * pos * neg + pos + neg;
+        if ( score > bestScore ) {
+          bestScore = score;
+          best = v;
         }
       }
+      if ( best < 0 )
+        return 1; // no free variable left in an unsatisfied clause
+      // the literal that reduces less leaves the easier, more likely
+      // satisfiable branch, so it goes first
+      int first = la->lookScore[ 2 * best ] <= la->lookScore[ 2 * best + 1 ] ? 2 * best : 2 * best + 1;
+      node.branch[0] = first;
+      node.branch[1] = litNeg( first );
+      node.mark = la->trail.size();
+      nodes.push_back( node );
     }
-    // otherwise UNSAT or backtrack
-    else {
-      if ( solver.decisionStack.empty() ) {
-        //UNSAT
-        std::cout << "unsat";
-        return;
-      }
-      else {
-        decision d = solver.decisionStack.top();
-        solver.decisionStack.pop();
-        int v = solver.sigmaStack.back();
-        // backtrack:
-        while ( v != d.var ) {
-          solver.sigma[v] = 0;
-          solver.sigmaStack.pop_back();
-          v = solver.sigmaStack.back();
-        }
-        solver.sigma[d.var] = 1;
-        d.assignment = 1;
-        // expand active clauses:
-        for ( int i = 0; i < solver.numClauses; i++ ) {
-          Clause c = solver.formula[i];
-          if ( c.hasLit( d.var ) )
-            solver.activeClauses.push_back( i );
-        }
+    // take the next branch of the deepest node that has one left, undoing
+    // the failed branch before it and closing the nodes that have none
+    bool descended = false;
+    while ( !nodes.empty() && !descended ) {
+      LookaheadNode& top = nodes.back();
+      if ( top.next > 0 )
+        unassignTo( la, top.mark );
+      if ( top.next == 2 ) {
+        dropLearned( la, top.learnedMark );
+        nodes.pop_back();
+        continue;
       }
+      stats->decisions++;
+      assign( la, top.branch[ top.next++ ] );
+      if ( propagate( la, stats ) )
+        descended = true;
+      else
+        stats->conflicts++;
+    }
+    if ( !descended )
+      return 0;
+  }
+}
+
+// Build the lookahead state from the parsed formula. Returns false if the
+// formula contains an empty clause.
+bool initLookahead ( DPLLSolver* solver, Lookahead* la ) {
+  int n = solver->numVars;
+  la->numVars = n;
+  la->occurs.assign( 2 * n + 2, std::vector<int>() );
+  la->implications.assign( 2 * n + 2, std::vector<int>() );
+  la->values.assign( 2 * n + 2, VALUE_UNDEF );
+  la->heuristic.assign( n + 1, 0 );
+  la->lookScore.assign( 2 * n + 2, 0 );
+  la->qhead = 0;
+  la->conflict = false;
+  la->reduction = 0;
+  la->dlTrigger = 0;
+  la->start.push_back( 0 );
+  std::vector<int> mark( 2 * n + 2, -1 );
+  for ( int i = 0; i < solver->numClauses; i++ ) {
+    Clause* c = &solver->formula[i];
+    int begin = la->lits.size();
+    bool tautology = false;
+    for ( int j = 0; j < c->numVars; j++ ) {
+      int lit = 2 * c->vars[j] + c->polarity[j];
+      if ( mark[ litNeg( lit ) ] == i )
+        tautology = true;
+      if ( mark[ lit ] == i )
+        continue;
+      mark[ lit ] = i;
+      la->lits.push_back( lit );
+    }
+    if ( tautology ) {
+      la->lits.resize( begin );
+      continue;
     }
+    int size = la->lits.size() - begin;
+    if ( size == 0 )
+      return false;
+    int index = la->start.size() - 1;
+    for ( int j = begin; j < la->lits.size(); j++ )
+      la->occurs[ la->lits[j] ].push_back( index );
+    la->start.push_back( la->lits.size() );
+    la->size.push_back( size );
+    la->satisfied.push_back( 0 );
+    if ( size == 1 )
+      la->units.push_back( index );
   }
-  if (time (NULL) > endTime)
+  // assignments made by the parser
+  for ( int v = 1; v < n + 1; v++ ) {
+    if ( solver->sigma[ v ] != 0 && la->values[ 2 * v ] == VALUE_UNDEF )
+      assign( la, solver->sigma[ v ] > 0 ? 2 * v : 2 * v + 1 );
+  }
+  return true;
+}
+
+void dpllEval ( DPLLSolver* solver, SearchLimits* limits, int verbose ) {
+  SolverStats localStats;
+  if ( !solver->stats )
+    solver->stats = &localStats;
+  SolverStats* stats = solver->stats;
+  stats->engine = "dpll";
+  timePoint solveStart = now();
+  limits->begin();
+  Lookahead la;
+  int result = 0;
+  if ( initLookahead( solver, &la ) && propagate( &la, stats ) )
+    result = lookaheadSearch( &la, limits, stats );
+  stats->solveTime = secondsSince( solveStart );
+  if ( result == 1 ) {
+    stats->result = "sat";
+    std::cout << "sat\n";
+    for ( int i = 1; i < solver->numVars + 1; i++ )
+      solver->sigma[ i ] = la.values[ 2 * i ] == VALUE_TRUE ? 1 : -1;
+    if ( verbose ) {
+      std::cout << "lit  val \n";
+      for ( int i = 1; i < solver->numVars + 1; i++)
+        std::cout << " " << i << "    " << solver->sigma[ i ] << "\n";
+    }
+  } else if ( result == 0 ) {
+    stats->result = "unsat";
+    std::cout << "unsat\n";
+  } else {
+    stats->stopReason = limits->reason;
     std::cout << "unknown";
+  }
+  if ( solver->stats == &localStats )
+    solver->stats = nullptr;
 }
@@ -1,15 +1,26 @@
-#ifndef DPLL_H 
+#ifndef DPLL_H
 #define DPLL_H
 
 #include <vector>
 #include "solver.h"
+#include "budget.h"
 #include <stack>
+#include <stdint.h>
 
 struct decision {
   int var;
   int assignment;
 };
 
+// lookahead tuning: at least LOOKAHEAD_MIN_CANDIDATES variables, or
+// LOOKAHEAD_CANDIDATE_PERCENT of the free ones, are looked ahead on per node;
+// double lookahead runs under a literal whose reduction beats a trigger that
+// decays by DL_TRIGGER_DECAY per node
+#define LOOKAHEAD_MIN_CANDIDATES 10
+#define LOOKAHEAD_CANDIDATE_PERCENT 10
+#define DL_MAX_CANDIDATES 20
+#define DL_TRIGGER_DECAY 0.9
+
 class DPLLSolver : public Solver {
 
   public:
@@ -18,20 +29,36 @@ class DPLLSolver : public Solver {
     DPLLSolver ( std::vector<Clause> form, std::vector<int> sigma, int numClauses, int numVars
         , std::vector<int> activeClauses );
     DPLLSolver ();
-    std::vector<int> getSingletons ();
 };
 
-decision unitRule ( Clause* clause, std::vector<int>* sigma, std::vector<int>* sigmaStack ); 
-
-decision makeDecision ( DPLLSolver* solver );
-
-void testWrapper( DPLLSolver solver );
-
-void dpllEval ( DPLLSolver solver, int time ); 
+// State of the lookahead search. Clause sizes are kept as counters that are
+// updated on every assignment and restored by unwinding the trail, so undoing
+// a lookahead costs the same as making it.
+struct Lookahead {
+  int numVars;
+  std::vector<int> lits; // encoded literals of clause c in lits[start[c]..start[c + 1])
+  std::vector<int> start;
+  std::vector< std::vector<int> > occurs; // clauses containing each literal
+  std::vector<int> size; // literals of each clause that are not false
+  std::vector<int> satisfied; // true literals of each clause
+  std::vector<int8_t> values; // indexed by literal
+  std::vector<int> trail; // assigned literals, the undo stack
+  int qhead; // next trail literal whose local implications are applied
+  std::vector<int> units; // clauses that became unit
+  bool conflict;
+  double reduction; // weighted clause size reduction since it was reset
+  // binaries learned by double lookahead, valid below the node that found them
+  std::vector< std::vector<int> > implications;
+  std::vector<int> learnedFrom; // literals with a local implication, in order
+  double dlTrigger;
+  std::vector<double> heuristic; // preselection score per variable
+  std::vector<double> lookScore; // reduction per literal at the current node
+};
 
-void pickClause ( DPLLSolver* solver, Clause* c );
+// Solve with lookahead DPLL and print the result; the model is left in sigma
+void dpllEval ( DPLLSolver* solver, SearchLimits* limits, int verbose );
 
 template<typename T>
-void dump_vec(std::vector<T>* vec); 
+void dump_vec(std::vector<T>* vec);
 
 #endif
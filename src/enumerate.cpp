@@ -0,0 +1,75 @@
+#include "enumerate.h"
+#include <stdlib.h>
+#include <string.h>
+
+ModelWriter::ModelWriter ( FILE* f ) : out( f ), buffer( MODEL_BUFFER_SIZE ), used( 0 ) {
+}
+
+ModelWriter::~ModelWriter () {
+  flush();
+}
+
+void ModelWriter::flush () {
+  if ( used > 0 )
+    fwrite( &buffer[0], 1, used, out );
+  used = 0;
+  fflush( out );
+}
+
+void ModelWriter::append ( const char* text, size_t size ) {
+  if ( used + size > buffer.size() ) {
+    fwrite( &buffer[0], 1, used, out );
+    used = 0;
+  }
+  memcpy( &buffer[ used ], text, size );
+  used += size;
+}
+
+void ModelWriter::write ( const std::vector<int>& sigma, const std::vector<int>& vars ) {
+  // one literal at most: space, sign and 10 digits
+  char lit[12];
+  append( "v", 1 );
+  for ( size_t i = 0; i < vars.size(); i++ ) {
+    unsigned int v = vars[i];
+    char* p = lit + sizeof( lit );
+    do {
+      *--p = '0' + v % 10;
+      v /= 10;
+    } while ( v );
+    if ( sigma[ vars[i] ] < 0 )
+      *--p = '-';
+    *--p = ' ';
+    append( p, lit + sizeof( lit ) - p );
+  }
+  append( " 0\n", 3 );
+}
+
+int cdclEnumerate ( CDCLSolver* solver, SearchLimits* limits, int verbose, ModelWriter* out ) {
+  SolverStats* stats = solver->stats;
+  stats->engine = "cdcl";
+  timePoint solveStart = now();
+  limits->begin();
+  std::vector<int> vars = solver->projection;
+  if ( vars.empty() ) {
+    for ( int v = 1; v < solver->numVars + 1; v++ )
+      vars.push_back( v );
+  }
+  int result = initSearch( solver ) ? RESULT_SAT : RESULT_UNSAT;
+  while ( result == RESULT_SAT ) {
+    result = cdclSearch( solver, limits, verbose, solveStart );
+    if ( result != RESULT_SAT )
+      break;
+    stats->models++;
+    out->write( solver->sigma, vars );
+    if ( !blockModel( solver ) )
+      result = RESULT_UNSAT;
+  }
+  endSearch( solver, result );
+  stats->solveTime = secondsSince( solveStart );
+  if ( result == RESULT_UNKNOWN )
+    stats->stopReason = limits->reason;
+  else
+    stats->result = stats->models ? "sat" : "unsat";
+  out->flush();
+  return result;
+}
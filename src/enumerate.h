@@ -0,0 +1,37 @@
+#ifndef ENUMERATE_H
+#define ENUMERATE_H
+
+#include <vector>
+#include <stdio.h>
+#include "cdcl.h"
+#include "budget.h"
+
+// models are collected in a buffer of MODEL_BUFFER_SIZE bytes, written out
+// whenever less than a line's worst case is left
+#define MODEL_BUFFER_SIZE ( 1 << 16 )
+
+// Writes models as DIMACS "v" lines, "v 1 -2 3 0", of the given variables
+// in their order. Lines are formatted into a buffer that goes to the file in
+// one write once it is full and when flushed, so a long enumeration streams
+// out in large blocks.
+struct ModelWriter {
+  FILE* out;
+  std::vector<char> buffer;
+  size_t used;
+  ModelWriter ( FILE* f );
+  ~ModelWriter ();
+  void write ( const std::vector<int>& sigma, const std::vector<int>& vars );
+  void flush ();
+  private:
+    void append ( const char* text, size_t size );
+};
+
+// Enumerate the models of the formula projected onto solver->projection, or
+// all its models when that is empty, writing each one as it is found. After
+// each model a clause of negated decisions blocks its projection and the
+// search goes on from one level below, keeping its learned clauses. Returns
+// RESULT_UNSAT once every model has been found and RESULT_UNKNOWN if a
+// budget ran out first; the models found are counted in the statistics.
+int cdclEnumerate ( CDCLSolver* solver, SearchLimits* limits, int verbose, ModelWriter* out );
+
+#endif
@@ -0,0 +1,123 @@
+#include "formulafeatures.h"
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+#include <string.h>
+
+// JSON name and field of every scalar feature
+struct FeatureField {
+  const char* name;
+  double Features::* field;
+};
+
+static const FeatureField featureFields[] = {
+  { "vars", &Features::vars },
+  { "clauses", &Features::clauses },
+  { "ratio", &Features::ratio },
+  { "unit_fraction", &Features::unitFraction },
+  { "binary_fraction", &Features::binaryFraction },
+  { "ternary_fraction", &Features::ternaryFraction },
+  { "horn_fraction", &Features::hornFraction },
+  { "positive_fraction", &Features::positiveFraction },
+  { "min_clause_size", &Features::minClauseSize },
+  { "max_clause_size", &Features::maxClauseSize },
+  { "mean_clause_size", &Features::meanClauseSize },
+  { "min_degree", &Features::minDegree },
+  { "max_degree", &Features::maxDegree },
+  { "mean_degree", &Features::meanDegree },
+  { "degree_cv", &Features::degreeCv },
+  { "xors", &Features::xors },
+  { "cards", &Features::cards },
+  { "assigned", &Features::assigned },
+  { "extract_time", &Features::extractTime },
+};
+
+void extractFeatures ( Solver* solver, Features* f ) {
+  timePoint start = now();
+  memset( f, 0, sizeof( Features ) );
+  int n = solver->numVars;
+  std::vector<int> degree( n + 1, 0 );
+  unsigned long long occurrences = 0;
+  unsigned long long positive = 0;
+  int horn = 0;
+  int minSize = -1;
+  int maxSize = 0;
+  int numClauses = solver->formula.size();
+  for ( int i = 0; i < numClauses; i++ ) {
+    const Clause& c = solver->formula[i];
+    int size = c.numVars;
+    int pos = 0;
+    for ( int j = 0; j < size; j++ ) {
+      degree[ c.vars[j] ]++;
+      pos += !c.polarity[j];
+    }
+    occurrences += size;
+    positive += pos;
+    horn += pos <= 1;
+    if ( minSize < 0 || size < minSize )
+      minSize = size;
+    if ( size > maxSize )
+      maxSize = size;
+    if ( size > 0 )
+      f->sizeHistogram[ std::min( size, FEATURE_SIZE_BINS ) - 1 ]++;
+  }
+  f->vars = n;
+  f->clauses = numClauses;
+  f->ratio = n ? (double) numClauses / n : 0;
+  f->minClauseSize = minSize < 0 ? 0 : minSize;
+  f->maxClauseSize = maxSize;
+  if ( numClauses ) {
+    for ( int b = 0; b < FEATURE_SIZE_BINS; b++ )
+      f->sizeHistogram[b] /= numClauses;
+    f->unitFraction = f->sizeHistogram[0];
+    f->binaryFraction = f->sizeHistogram[1];
+    f->ternaryFraction = f->sizeHistogram[2];
+    f->hornFraction = (double) horn / numClauses;
+    f->meanClauseSize = (double) occurrences / numClauses;
+  }
+  if ( occurrences )
+    f->positiveFraction = (double) positive / occurrences;
+  int occurring = 0;
+  double sum = 0;
+  double sumSquares = 0;
+  for ( int v = 1; v < n + 1; v++ ) {
+    if ( degree[v] == 0 )
+      continue;
+    if ( occurring == 0 || degree[v] < f->minDegree )
+      f->minDegree = degree[v];
+    if ( degree[v] > f->maxDegree )
+      f->maxDegree = degree[v];
+    occurring++;
+    sum += degree[v];
+    sumSquares += (double) degree[v] * degree[v];
+  }
+  if ( occurring ) {
+    f->meanDegree = sum / occurring;
+    double variance = std::max( 0.0, sumSquares / occurring - f->meanDegree * f->meanDegree );
+    f->degreeCv = std::sqrt( variance ) / f->meanDegree;
+  }
+  f->xors = solver->xors.size();
+  f->cards = solver->cards.size();
+  f->assigned = solver->numAssigned;
+  f->extractTime = secondsSince( start );
+}
+
+bool featureValue ( const Features* features, const std::string& name, double* value ) {
+  for ( int i = 0; i < sizeof( featureFields ) / sizeof( featureFields[0] ); i++ ) {
+    if ( name == featureFields[i].name ) {
+      *value = features->*featureFields[i].field;
+      return true;
+    }
+  }
+  return false;
+}
+
+void printFeaturesJson ( const Features* features, std::ostream& out ) {
+  out << std::setprecision( 6 ) << "{";
+  for ( int i = 0; i < sizeof( featureFields ) / sizeof( featureFields[0] ); i++ )
+    out << ( i ? ", " : "" ) << "\"" << featureFields[i].name << "\": " << features->*featureFields[i].field;
+  out << ", \"size_histogram\": [";
+  for ( int b = 0; b < FEATURE_SIZE_BINS; b++ )
+    out << ( b ? ", " : "" ) << features->sizeHistogram[b];
+  out << "]}\n";
+}
@@ -0,0 +1,44 @@
+#ifndef FORMULAFEATURES_H
+#define FORMULAFEATURES_H
+
+#include <ostream>
+#include "solver.h"
+
+// clause sizes 1 .. FEATURE_SIZE_BINS - 1 have their own histogram bin, the
+// last bin holds every longer clause
+#define FEATURE_SIZE_BINS 9
+
+// Syntactic features of a parsed formula, computed in one pass over the
+// clauses. Fractions are of the clauses unless noted otherwise.
+struct Features {
+  double vars;
+  double clauses;
+  double ratio; // clauses per variable
+  double unitFraction;
+  double binaryFraction;
+  double ternaryFraction;
+  double hornFraction; // at most one positive literal
+  double positiveFraction; // of the literal occurrences
+  double minClauseSize;
+  double maxClauseSize;
+  double meanClauseSize;
+  double minDegree; // occurrences per variable, over variables that occur
+  double maxDegree;
+  double meanDegree;
+  double degreeCv; // standard deviation of the degree over its mean
+  double xors;
+  double cards;
+  double assigned; // variables fixed by the parser
+  double extractTime;
+  double sizeHistogram[ FEATURE_SIZE_BINS ]; // fraction of clauses per size
+};
+
+void extractFeatures ( Solver* solver, Features* features );
+
+// Value of the feature with the given JSON name, false if there is none
+bool featureValue ( const Features* features, const std::string& name, double* value );
+
+// all features as a single JSON object
+void printFeaturesJson ( const Features* features, std::ostream& out );
+
+#endif
@@ -0,0 +1,258 @@
+#include "gauss.h"
+#include "literal.h"
+#include <algorithm>
+
+XorMatrix::XorMatrix () {
+  numRows = 0;
+  numCols = 0;
+  words = 0;
+  topLevel = 0;
+}
+
+bool XorMatrix::init ( const std::vector<Xor>* xors, int numVars ) {
+  varCol.assign( numVars + 1, -1 );
+  colVar.clear();
+  for ( int i = 0; i < xors->size(); i++ ) {
+    const std::vector<unsigned int>& vars = ( *xors )[i].vars;
+    for ( int k = 0; k < vars.size(); k++ ) {
+      if ( varCol[ vars[k] ] < 0 ) {
+        varCol[ vars[k] ] = colVar.size();
+        colVar.push_back( vars[k] );
+      }
+    }
+  }
+  numRows = xors->size();
+  numCols = colVar.size();
+  words = ( numCols + 63 ) / 64;
+  rows.assign( numRows * words, 0 );
+  rhs.assign( numRows, 0 );
+  for ( int r = 0; r < numRows; r++ ) {
+    const Xor& x = ( *xors )[r];
+    for ( int k = 0; k < x.vars.size(); k++ ) {
+      int col = varCol[ x.vars[k] ];
+      rows[ r * words + col / 64 ] ^= 1ULL << ( col % 64 );
+    }
+    rhs[r] = x.rhs;
+  }
+  pivot.assign( numRows, -1 );
+  watch.assign( numRows, -1 );
+  pivotRow.assign( numCols, -1 );
+  watchers.resize( numCols );
+  for ( int col = 0; col < numCols; col++ )
+    watchers[ col ].clear();
+  listed.assign( numRows, 0 );
+  resolved.assign( numRows, 0 );
+  for ( int l = 0; l < resolvedAt.size(); l++ )
+    resolvedAt[l].clear();
+  topLevel = 0;
+  queued.assign( numRows, 0 );
+  queue.clear();
+  assigned.assign( words, 0 );
+  isTrue.assign( words, 0 );
+
+  // Gauss-Jordan elimination with nothing assigned, pivoting each row on
+  // its column in the fewest rows to keep the rows sparse. Rows of one
+  // column are left for the first propagation to assign at level 0.
+  std::vector<int> counts( numCols, 0 );
+  for ( int r = 0; r < numRows; r++ )
+    countRow( r, &counts, 1 );
+  for ( int r = 0; r < numRows; r++ ) {
+    const uint64_t* row = &rows[ r * words ];
+    int n = 0;
+    int best = -1;
+    int other = -1;
+    for ( int k = 0; k < words; k++ ) {
+      uint64_t bits = row[k];
+      while ( bits ) {
+        int col = 64 * k + __builtin_ctzll( bits );
+        bits &= bits - 1;
+        n++;
+        if ( best < 0 || counts[ col ] < counts[ best ] ) {
+          other = best;
+          best = col;
+        } else if ( other < 0 ) {
+          other = col;
+        }
+      }
+    }
+    if ( n == 0 && rhs[r] )
+      return false;
+    if ( n == 0 ) {
+      resolve( r, 0 );
+    } else if ( n == 1 ) {
+      push( r );
+    } else {
+      makePivot( r, best, &counts );
+      setWatch( r, other );
+    }
+  }
+  return true;
+}
+
+// Add sign times the columns of row r to counts
+void XorMatrix::countRow ( int r, std::vector<int>* counts, int sign ) {
+  const uint64_t* row = &rows[ r * words ];
+  for ( int k = 0; k < words; k++ ) {
+    uint64_t bits = row[k];
+    while ( bits ) {
+      ( *counts )[ 64 * k + __builtin_ctzll( bits ) ] += sign;
+      bits &= bits - 1;
+    }
+  }
+}
+
+void XorMatrix::assign ( int var, bool value ) {
+  int col = varCol[ var ];
+  uint64_t bit = 1ULL << ( col % 64 );
+  assigned[ col / 64 ] |= bit;
+  if ( value )
+    isTrue[ col / 64 ] |= bit;
+  else
+    isTrue[ col / 64 ] &= ~bit;
+  int r = pivotRow[ col ];
+  if ( r >= 0 && !resolved[r] )
+    push( r );
+  std::vector<int>& ws = watchers[ col ];
+  for ( int i = 0; i < ws.size(); i++ ) {
+    r = ws[i];
+    if ( watch[r] != col )
+      continue; // moved on since
+    listed[r] = 0;
+    if ( !resolved[r] )
+      push( r );
+  }
+  ws.clear();
+}
+
+void XorMatrix::unassign ( int var ) {
+  int col = varCol[ var ];
+  assigned[ col / 64 ] &= ~( 1ULL << ( col % 64 ) );
+  isTrue[ col / 64 ] &= ~( 1ULL << ( col % 64 ) );
+}
+
+void XorMatrix::backtrack ( int level ) {
+  for ( ; topLevel > level; topLevel-- ) {
+    std::vector<int>& rs = resolvedAt[ topLevel ];
+    for ( int i = 0; i < rs.size(); i++ ) {
+      resolved[ rs[i] ] = 0;
+      push( rs[i] );
+    }
+    rs.clear();
+  }
+}
+
+void XorMatrix::push ( int r ) {
+  if ( queued[r] )
+    return;
+  queued[r] = 1;
+  queue.push_back( r );
+}
+
+void XorMatrix::resolve ( int r, int level ) {
+  resolved[r] = 1;
+  if ( resolvedAt.size() <= level )
+    resolvedAt.resize( level + 1 );
+  resolvedAt[ level ].push_back( r );
+  topLevel = std::max( topLevel, level );
+}
+
+void XorMatrix::setWatch ( int r, int col ) {
+  if ( watch[r] == col && listed[r] )
+    return;
+  watch[r] = col;
+  watchers[ col ].push_back( r );
+  listed[r] = 1;
+}
+
+// Make col the pivot of row r by adding r to every other row containing
+// it. Those rows keep their own pivots, which r does not contain, but may
+// lose their watch. Column counts, if given, are kept up to date.
+void XorMatrix::makePivot ( int r, int col, std::vector<int>* counts ) {
+  if ( pivot[r] >= 0 )
+    pivotRow[ pivot[r] ] = -1;
+  pivot[r] = col;
+  pivotRow[ col ] = r;
+  const uint64_t* source = &rows[ r * words ];
+  int w = col / 64;
+  uint64_t bit = 1ULL << ( col % 64 );
+  for ( int j = 0; j < numRows; j++ ) {
+    uint64_t* row = &rows[ j * words ];
+    if ( j == r || !( row[w] & bit ) )
+      continue;
+    if ( counts )
+      countRow( j, counts, -1 );
+    for ( int k = 0; k < words; k++ )
+      row[k] ^= source[k];
+    if ( counts )
+      countRow( j, counts, 1 );
+    rhs[j] ^= rhs[r];
+    if ( watch[j] >= 0 && !isSet( j, watch[j] ) )
+      push( j );
+  }
+}
+
+// Bring row r in line with the assignment. With two or more unassigned
+// columns it gets an unassigned pivot and watch. Otherwise it is resolved
+// and, unless it is satisfied, its clause is left in lits: the implied
+// literal first, if any, then the false literals of its assigned columns.
+// level is the highest level of those.
+int XorMatrix::check ( int r, const int* levels, std::vector<int>* lits, int* level ) {
+  const uint64_t* row = &rows[ r * words ];
+  int open[2];
+  int n = 0;
+  for ( int k = 0; k < words && n < 2; k++ ) {
+    uint64_t free = row[k] & ~assigned[k];
+    while ( free && n < 2 ) {
+      open[ n++ ] = 64 * k + __builtin_ctzll( free );
+      free &= free - 1;
+    }
+  }
+  if ( n == 2 ) {
+    bool pivotOpen = pivot[r] >= 0 && !isAssigned( pivot[r] );
+    bool watchOpen = watch[r] >= 0 && watch[r] != pivot[r] && isSet( r, watch[r] ) && !isAssigned( watch[r] );
+    if ( !pivotOpen )
+      makePivot( r, watchOpen && open[0] == watch[r] ? open[1] : open[0] );
+    if ( !watchOpen || watch[r] == pivot[r] )
+      setWatch( r, open[0] == pivot[r] ? open[1] : open[0] );
+    else
+      setWatch( r, watch[r] );
+    return GAUSS_NONE;
+  }
+  int parity = rhs[r];
+  for ( int k = 0; k < words; k++ )
+    parity ^= __builtin_popcountll( row[k] & isTrue[k] ) & 1;
+  lits->clear();
+  if ( n == 1 )
+    lits->push_back( 2 * colVar[ open[0] ] + ( parity ? 0 : 1 ) );
+  bool satisfied = n == 0 && parity == 0;
+  *level = 0;
+  for ( int k = 0; k < words; k++ ) {
+    uint64_t bits = row[k] & assigned[k];
+    while ( bits ) {
+      int col = 64 * k + __builtin_ctzll( bits );
+      bits &= bits - 1;
+      *level = std::max( *level, levels[ colVar[col] ] );
+      if ( !satisfied )
+        lits->push_back( 2 * colVar[col] + ( ( isTrue[k] >> ( col % 64 ) ) & 1 ) );
+    }
+  }
+  resolve( r, *level );
+  return satisfied ? GAUSS_NONE : n == 1 ? GAUSS_UNIT : GAUSS_CONFLICT;
+}
+
+// Check the rows whose pivot or watch was assigned, or that came back on a
+// backtrack, until one implies a literal or is violated. Its clause is left
+// in lits and its level in level; GAUSS_NONE once every row is in line.
+int XorMatrix::propagate ( const int* levels, std::vector<int>* lits, int* level ) {
+  while ( !queue.empty() ) {
+    int r = queue.back();
+    queue.pop_back();
+    queued[r] = 0;
+    if ( resolved[r] )
+      continue;
+    int found = check( r, levels, lits, level );
+    if ( found != GAUSS_NONE )
+      return found;
+  }
+  return GAUSS_NONE;
+}
@@ -0,0 +1,67 @@
+#ifndef GAUSS_H
+#define GAUSS_H
+
+#include <vector>
+#include <stdint.h>
+#include "solver.h"
+
+// what XorMatrix::propagate found
+#define GAUSS_NONE 0
+#define GAUSS_UNIT 1 // a row with one unassigned column implies it
+#define GAUSS_CONFLICT 2 // a fully assigned row is violated
+
+// XOR constraints as a matrix over GF(2): one row per constraint, one bit
+// column per variable that occurs in any of them, 64 columns per word.
+//
+// The matrix is kept in reduced row echelon form: every row with two or
+// more unassigned columns has a pivot column of its own, unassigned and in
+// no other row, and watches a second unassigned column. A combination of
+// such rows keeps the pivots of all of them, so no combination has fewer
+// than two unassigned columns and implies nothing. Only a row whose pivot
+// or watch gets assigned has to be looked at: it moves its watch to another
+// unassigned column, or makes one its new pivot by adding itself to the
+// other rows containing it, or else implies its last column or is violated.
+// Such a row is resolved at the highest level of its columns and comes back
+// when that level is undone; row operations keep the system equivalent, so
+// the matrix itself is never restored.
+struct XorMatrix {
+  int numRows;
+  int numCols;
+  int words; // per row
+  std::vector<int> colVar; // variable of each column
+  std::vector<int> varCol; // column of each variable, -1 if in no row
+  std::vector<uint64_t> rows; // row r in rows[r * words..(r + 1) * words)
+  std::vector<char> rhs;
+  std::vector<int> pivot; // column of each row, -1 before it has one
+  std::vector<int> watch; // second unassigned column of each row, -1 for none
+  std::vector<int> pivotRow; // row each column is the pivot of, -1 for none
+  std::vector< std::vector<int> > watchers; // rows watching each column, may be stale
+  std::vector<char> listed; // the row is in the watchers of its watch
+  std::vector<char> resolved; // at most one unassigned column, handled
+  std::vector< std::vector<int> > resolvedAt; // rows resolved at each level
+  int topLevel; // levels above it have no resolved rows
+  std::vector<char> queued;
+  std::vector<int> queue; // rows to check against the assignment
+  std::vector<uint64_t> assigned; // columns with a value
+  std::vector<uint64_t> isTrue; // columns assigned true
+  XorMatrix ();
+  // load the constraints and eliminate them; false if they are inconsistent
+  bool init ( const std::vector<Xor>* xors, int numVars );
+  bool empty () const { return numRows == 0; }
+  bool contains ( int var ) const { return varCol[ var ] >= 0; }
+  void assign ( int var, bool value );
+  void unassign ( int var );
+  void backtrack ( int level ); // bring back the rows resolved above level
+  int propagate ( const int* levels, std::vector<int>* lits, int* level );
+  private:
+    bool isSet ( int r, int col ) const { return ( rows[ r * words + col / 64 ] >> ( col % 64 ) ) & 1; }
+    bool isAssigned ( int col ) const { return ( assigned[ col / 64 ] >> ( col % 64 ) ) & 1; }
+    void push ( int r );
+    void resolve ( int r, int level );
+    void setWatch ( int r, int col );
+    void makePivot ( int r, int col, std::vector<int>* counts = nullptr );
+    void countRow ( int r, std::vector<int>* counts, int sign );
+    int check ( int r, const int* levels, std::vector<int>* lits, int* level );
+};
+
+#endif
@@ -0,0 +1,188 @@
+#include "generators.h"
+#include <vector>
+#include <set>
+#include <random>
+#include <sstream>
+#include <iostream>
+#include <string>
+#include <stdlib.h>
+
+typedef std::vector< std::vector<int> > clauseList;
+
+// write clauses with a DIMACS header
+void writeDimacs ( int numVars, clauseList* clauses, std::ostream& out ) {
+  out << "p cnf " << numVars << " " << clauses->size() << "\n";
+  for ( int i = 0; i < clauses->size(); i++ ) {
+    for ( int j = 0; j < (*clauses)[i].size(); j++ )
+      out << (*clauses)[i][j] << " ";
+    out << "0\n";
+  }
+}
+
+// clause/variable ratio at the satisfiability threshold for small k
+double thresholdRatio ( int k ) {
+  switch ( k ) {
+    case 2: return 1.0;
+    case 3: return 4.26;
+    case 4: return 9.93;
+    case 5: return 21.12;
+    case 6: return 43.37;
+    default: return 87.79;
+  }
+}
+
+void generateRandomKSat ( int numVars, int k, unsigned int seed, std::ostream& out ) {
+  std::mt19937 rng( seed );
+  int numClauses = (int) ( thresholdRatio( k ) * numVars + 0.5 );
+  clauseList clauses;
+  for ( int i = 0; i < numClauses; i++ ) {
+    std::vector<int> clause;
+    while ( clause.size() < k ) {
+      int v = rng() % numVars + 1;
+      bool seen = false;
+      for ( int j = 0; j < clause.size(); j++ )
+        if ( abs( clause[j] ) == v ) seen = true;
+      if ( seen ) continue;
+      clause.push_back( rng() % 2 ? v : -v );
+    }
+    clauses.push_back( clause );
+  }
+  out << "c random " << k << "-SAT, seed " << seed << "\n";
+  writeDimacs( numVars, &clauses, out );
+}
+
+void generatePigeonhole ( int holes, std::ostream& out ) {
+  int pigeons = holes + 1;
+  clauseList clauses;
+  // variable for pigeon p in hole h
+  #define PH( p, h ) ( (p) * holes + (h) + 1 )
+  for ( int p = 0; p < pigeons; p++ ) {
+    std::vector<int> clause;
+    for ( int h = 0; h < holes; h++ )
+      clause.push_back( PH( p, h ) );
+    clauses.push_back( clause );
+  }
+  for ( int h = 0; h < holes; h++ )
+    for ( int p = 0; p < pigeons; p++ )
+      for ( int q = p + 1; q < pigeons; q++ )
+        clauses.push_back( { -PH( p, h ), -PH( q, h ) } );
+  #undef PH
+  out << "c pigeonhole " << pigeons << " into " << holes << "\n";
+  writeDimacs( pigeons * holes, &clauses, out );
+}
+
+// Tseitin clauses for out <-> a xor b
+void addXor ( clauseList* clauses, int out, int a, int b ) {
+  clauses->push_back( { -out, a, b } );
+  clauses->push_back( { -out, -a, -b } );
+  clauses->push_back( { out, -a, b } );
+  clauses->push_back( { out, a, -b } );
+}
+
+void generateParity ( int numVars, bool satisfiable, unsigned int seed, std::ostream& out ) {
+  std::mt19937 rng( seed );
+  if ( numVars < 2 ) numVars = 2;
+  std::vector<int> order;
+  for ( int i = 1; i <= numVars; i++ )
+    order.push_back( i );
+  // Fisher-Yates with the raw engine, std::shuffle is not portable
+  for ( int i = numVars - 1; i > 0; i-- ) {
+    int j = rng() % ( i + 1 );
+    int tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+  clauseList clauses;
+  int next = numVars + 1;
+  int chainA = 1;
+  int chainB = order[0];
+  for ( int i = 1; i < numVars; i++ ) {
+    addXor( &clauses, next, chainA, i + 1 );
+    chainA = next++;
+    addXor( &clauses, next, chainB, order[i] );
+    chainB = next++;
+  }
+  clauses.push_back( { chainA } );
+  clauses.push_back( { satisfiable ? chainB : -chainB } );
+  out << "c parity " << numVars << ( satisfiable ? " sat" : " unsat" ) << ", seed " << seed << "\n";
+  writeDimacs( next - 1, &clauses, out );
+}
+
+void generateColoring ( int vertices, int colors, bool satisfiable, unsigned int seed, std::ostream& out ) {
+  std::mt19937 rng( seed );
+  if ( vertices < colors + 1 ) vertices = colors + 1;
+  std::vector<int> hidden;
+  for ( int v = 0; v < vertices; v++ )
+    hidden.push_back( rng() % colors );
+  // edge density just below the colorability threshold for the planted graph
+  int numEdges = (int) ( vertices * ( colors == 3 ? 2.1 : colors * 1.0 ) );
+  std::set< std::pair<int, int> > edges;
+  if ( !satisfiable ) {
+    for ( int u = 0; u <= colors; u++ )
+      for ( int v = u + 1; v <= colors; v++ )
+        edges.insert( std::make_pair( u, v ) );
+  }
+  int attempts = 0;
+  while ( edges.size() < numEdges && attempts++ < numEdges * 100 ) {
+    int u = rng() % vertices;
+    int v = rng() % vertices;
+    if ( u == v || hidden[u] == hidden[v] ) continue;
+    edges.insert( std::make_pair( u < v ? u : v, u < v ? v : u ) );
+  }
+  clauseList clauses;
+  #define VC( v, c ) ( (v) * colors + (c) + 1 )
+  for ( int v = 0; v < vertices; v++ ) {
+    std::vector<int> clause;
+    for ( int c = 0; c < colors; c++ )
+      clause.push_back( VC( v, c ) );
+    clauses.push_back( clause );
+    for ( int c = 0; c < colors; c++ )
+      for ( int d = c + 1; d < colors; d++ )
+        clauses.push_back( { -VC( v, c ), -VC( v, d ) } );
+  }
+  std::set< std::pair<int, int> >::iterator it;
+  for ( it = edges.begin(); it != edges.end(); it++ )
+    for ( int c = 0; c < colors; c++ )
+      clauses.push_back( { -VC( it->first, c ), -VC( it->second, c ) } );
+  #undef VC
+  out << "c " << colors << "-coloring of " << vertices << " vertices, "
+      << edges.size() << " edges, seed " << seed << "\n";
+  writeDimacs( vertices * colors, &clauses, out );
+}
+
+bool generateFromSpec ( std::string spec, std::ostream& out ) {
+  std::vector<std::string> fields;
+  std::stringstream ss( spec );
+  std::string field;
+  while ( getline( ss, field, ':' ) )
+    fields.push_back( field );
+  if ( fields.empty() )
+    return false;
+  std::vector<int> args;
+  try {
+    for ( int i = 1; i < fields.size(); i++ )
+      args.push_back( std::stoi( fields[i] ) );
+  } catch ( std::exception& e ) {
+    return false;
+  }
+  std::string name = fields[0];
+  if ( name == "ksat" && args.size() == 3 && args[0] > 0 && args[1] > 0 && args[1] <= args[0] )
+    generateRandomKSat( args[0], args[1], args[2], out );
+  else if ( name == "php" && args.size() == 1 && args[0] > 0 )
+    generatePigeonhole( args[0], out );
+  else if ( name == "parity" && args.size() == 3 && args[0] > 0 )
+    generateParity( args[0], args[1] != 0, args[2], out );
+  else if ( name == "color" && args.size() == 4 && args[0] > 0 && args[1] > 0 )
+    generateColoring( args[0], args[1], args[2] != 0, args[3], out );
+  else
+    return false;
+  return true;
+}
+
+void generatorHelp () {
+  std::cout << "Generator specs for --generate (DIMACS is written to stdout):\n";
+  std::cout << "ksat:VARS:K:SEED                random K-SAT at the phase transition\n";
+  std::cout << "php:HOLES                       pigeonhole, HOLES+1 pigeons (unsat)\n";
+  std::cout << "parity:VARS:SAT:SEED            two XOR chains, SAT is 1 or 0\n";
+  std::cout << "color:VERTICES:COLORS:SAT:SEED  planted coloring, SAT 0 adds a clique\n";
+}
@@ -0,0 +1,30 @@
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+#include <ostream>
+#include <string>
+
+// Instance generators writing DIMACS CNF. All of them are deterministic for a
+// given seed on every platform (mt19937 without library distributions).
+
+// uniform random k-SAT with the clause/variable ratio at the phase transition
+void generateRandomKSat ( int numVars, int k, unsigned int seed, std::ostream& out );
+
+// holes + 1 pigeons into holes holes, always unsatisfiable
+void generatePigeonhole ( int holes, std::ostream& out );
+
+// XOR of numVars variables computed by two Tseitin chains over different
+// variable orders; satisfiable iff both chains are asserted to the same value
+void generateParity ( int numVars, bool satisfiable, unsigned int seed, std::ostream& out );
+
+// graph coloring with a planted coloring (satisfiable); adding a clique of
+// size colors + 1 makes it unsatisfiable
+void generateColoring ( int vertices, int colors, bool satisfiable, unsigned int seed, std::ostream& out );
+
+// parse a spec such as "ksat:50:3:7" and run the matching generator,
+// returns false on an unknown or malformed spec
+bool generateFromSpec ( std::string spec, std::ostream& out );
+
+void generatorHelp ();
+
+#endif
@@ -0,0 +1,305 @@
+#include "input.h"
+#include <algorithm>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <lzma.h>
+#include <bzlib.h>
+
+#define DECODE_MORE 0 // wants more input or output space
+#define DECODE_END 1 // a complete stream ended, another may follow
+#define DECODE_ERROR 2
+
+// One input format. decode consumes from *in and writes to *out, advancing
+// both and shrinking their sizes, until one of them is used up or a stream
+// ends.
+struct Decoder {
+  virtual ~Decoder () {}
+  virtual int decode ( const char** in, size_t* inSize, char** out, size_t* outSize ) = 0;
+};
+
+struct PlainDecoder : public Decoder {
+  int decode ( const char** in, size_t* inSize, char** out, size_t* outSize ) {
+    size_t n = std::min( *inSize, *outSize );
+    memcpy( *out, *in, n );
+    *in += n;
+    *inSize -= n;
+    *out += n;
+    *outSize -= n;
+    // any point between reads is a complete plain file
+    return *inSize == 0 ? DECODE_END : DECODE_MORE;
+  }
+};
+
+struct GzipDecoder : public Decoder {
+  z_stream z;
+  GzipDecoder () {
+    memset( &z, 0, sizeof( z ) );
+    inflateInit2( &z, 15 + 32 ); // expect a gzip or zlib header
+  }
+  ~GzipDecoder () {
+    inflateEnd( &z );
+  }
+  int decode ( const char** in, size_t* inSize, char** out, size_t* outSize ) {
+    z.next_in = (Bytef*) *in;
+    z.avail_in = *inSize;
+    z.next_out = (Bytef*) *out;
+    z.avail_out = *outSize;
+    int status = inflate( &z, Z_NO_FLUSH );
+    *in = (const char*) z.next_in;
+    *inSize = z.avail_in;
+    *out = (char*) z.next_out;
+    *outSize = z.avail_out;
+    if ( status == Z_STREAM_END ) {
+      inflateReset( &z ); // the next member of a concatenation
+      return DECODE_END;
+    }
+    return status == Z_OK || status == Z_BUF_ERROR ? DECODE_MORE : DECODE_ERROR;
+  }
+};
+
+struct XzDecoder : public Decoder {
+  lzma_stream x;
+  bool ready; // the decoder could be set up
+  XzDecoder () {
+    x = LZMA_STREAM_INIT;
+    ready = lzma_stream_decoder( &x, UINT64_MAX, 0 ) == LZMA_OK;
+  }
+  ~XzDecoder () {
+    lzma_end( &x );
+  }
+  int decode ( const char** in, size_t* inSize, char** out, size_t* outSize ) {
+    if ( !ready )
+      return DECODE_ERROR;
+    x.next_in = (const uint8_t*) *in;
+    x.avail_in = *inSize;
+    x.next_out = (uint8_t*) *out;
+    x.avail_out = *outSize;
+    lzma_ret status = lzma_code( &x, LZMA_RUN );
+    *in = (const char*) x.next_in;
+    *inSize = x.avail_in;
+    *out = (char*) x.next_out;
+    *outSize = x.avail_out;
+    if ( status == LZMA_STREAM_END ) {
+      ready = lzma_stream_decoder( &x, UINT64_MAX, 0 ) == LZMA_OK;
+      return DECODE_END;
+    }
+    return status == LZMA_OK || status == LZMA_BUF_ERROR ? DECODE_MORE : DECODE_ERROR;
+  }
+};
+
+struct Bzip2Decoder : public Decoder {
+  bz_stream b;
+  Bzip2Decoder () {
+    memset( &b, 0, sizeof( b ) );
+    BZ2_bzDecompressInit( &b, 0, 0 );
+  }
+  ~Bzip2Decoder () {
+    BZ2_bzDecompressEnd( &b );
+  }
+  int decode ( const char** in, size_t* inSize, char** out, size_t* outSize ) {
+    b.next_in = (char*) *in;
+    b.avail_in = *inSize;
+    b.next_out = *out;
+    b.avail_out = *outSize;
+    int status = BZ2_bzDecompress( &b );
+    *in = b.next_in;
+    *inSize = b.avail_in;
+    *out = b.next_out;
+    *outSize = b.avail_out;
+    if ( status == BZ_STREAM_END ) {
+      BZ2_bzDecompressEnd( &b );
+      BZ2_bzDecompressInit( &b, 0, 0 );
+      return DECODE_END;
+    }
+    return status == BZ_OK ? DECODE_MORE : DECODE_ERROR;
+  }
+};
+
+PipelinedBuf::PipelinedBuf () {
+  fd = -1;
+  ownsFd = false;
+  formatName = "plain";
+  decoder = NULL;
+  setg( NULL, NULL, NULL );
+}
+
+PipelinedBuf::~PipelinedBuf () {
+  close();
+}
+
+// Tell the format by the first bytes and start the reader thread
+bool PipelinedBuf::open ( int inputFd, bool owns ) {
+  close();
+  fd = inputFd;
+  ownsFd = owns;
+  in.resize( INPUT_READ_SIZE );
+  inPos = 0;
+  inEnd = 0;
+  inEof = false;
+  errorText.clear();
+  while ( inEnd < 6 && !inEof ) {
+    ssize_t n = read( fd, &in[ inEnd ], 6 - inEnd );
+    if ( n < 0 && errno == EINTR )
+      continue;
+    if ( n < 0 )
+      errorText = std::string( "read error: " ) + strerror( errno );
+    if ( n <= 0 )
+      inEof = true;
+    else
+      inEnd += n;
+  }
+  const unsigned char* magic = (const unsigned char*) &in[0];
+  if ( inEnd >= 2 && magic[0] == 0x1f && magic[1] == 0x8b ) {
+    formatName = "gzip";
+    decoder = new GzipDecoder();
+  } else if ( inEnd >= 6 && !memcmp( magic, "\xfd" "7zXZ\0", 6 ) ) {
+    formatName = "xz";
+    decoder = new XzDecoder();
+  } else if ( inEnd >= 3 && !memcmp( magic, "BZh", 3 ) ) {
+    formatName = "bzip2";
+    decoder = new Bzip2Decoder();
+  } else {
+    formatName = "plain";
+    decoder = new PlainDecoder();
+  }
+  slots.assign( INPUT_RING_SLOTS, std::vector<char>( INPUT_BUFFER_SIZE ) );
+  filled.assign( INPUT_RING_SLOTS, 0 );
+  produced = 0;
+  consumed = 0;
+  reading = false;
+  done = false;
+  closing = false;
+  setg( NULL, NULL, NULL );
+  reader = std::thread( &PipelinedBuf::run, this );
+  return true;
+}
+
+// Stop the reader thread, which may be waiting for a free slot
+void PipelinedBuf::close () {
+  if ( reader.joinable() ) {
+    {
+      std::lock_guard<std::mutex> guard( lock );
+      closing = true;
+    }
+    changed.notify_all();
+    reader.join();
+  }
+  delete decoder;
+  decoder = NULL;
+  if ( ownsFd && fd >= 0 )
+    ::close( fd );
+  fd = -1;
+}
+
+// Read the next block of input. Returns false at its end or on an error.
+bool PipelinedBuf::readInput () {
+  inPos = 0;
+  inEnd = 0;
+  while ( !inEof ) {
+    ssize_t n = read( fd, &in[0], in.size() );
+    if ( n < 0 && errno == EINTR )
+      continue;
+    if ( n < 0 )
+      errorText = std::string( "read error: " ) + strerror( errno );
+    if ( n <= 0 ) {
+      inEof = true;
+      break;
+    }
+    inEnd = n;
+    return true;
+  }
+  return false;
+}
+
+// Next free slot of the ring, null once the parser has stopped
+char* PipelinedBuf::acquire () {
+  std::unique_lock<std::mutex> guard( lock );
+  changed.wait( guard, [this] { return closing || produced - consumed < INPUT_RING_SLOTS; } );
+  return closing ? NULL : &slots[ produced % INPUT_RING_SLOTS ][0];
+}
+
+// Hand the slot from acquire to the parser. Returns false once the parser
+// has stopped.
+bool PipelinedBuf::publish ( size_t size ) {
+  {
+    std::lock_guard<std::mutex> guard( lock );
+    if ( closing )
+      return false;
+    if ( size > 0 ) {
+      filled[ produced % INPUT_RING_SLOTS ] = size;
+      produced++;
+    }
+  }
+  changed.notify_all();
+  return true;
+}
+
+// Reader thread: decode the input into the slots of the ring
+void PipelinedBuf::run () {
+  char* out = acquire();
+  size_t outSize = INPUT_BUFFER_SIZE;
+  bool ended = inEnd == 0; // an empty input is complete
+  bool needInput = inEnd == 0;
+  while ( out ) {
+    if ( needInput && !readInput() )
+      break;
+    const char* next = &in[ inPos ];
+    size_t inSize = inEnd - inPos;
+    char* to = out + INPUT_BUFFER_SIZE - outSize;
+    size_t before = inSize + outSize;
+    int status = decoder->decode( &next, &inSize, &to, &outSize );
+    inPos = inEnd - inSize;
+    if ( status == DECODE_ERROR || ( status == DECODE_MORE && inSize + outSize == before && inSize > 0 ) ) {
+      errorText = std::string( "corrupt " ) + formatName + " data";
+      break;
+    }
+    ended = status == DECODE_END;
+    if ( outSize == 0 ) {
+      out = publish( INPUT_BUFFER_SIZE ) ? acquire() : NULL;
+      outSize = INPUT_BUFFER_SIZE;
+    }
+    // the decoder stops early only once the input is used up
+    needInput = inPos == inEnd;
+  }
+  if ( out && errorText.empty() && !ended )
+    errorText = std::string( "unexpected end of " ) + formatName + " data";
+  if ( out )
+    publish( INPUT_BUFFER_SIZE - outSize );
+  {
+    std::lock_guard<std::mutex> guard( lock );
+    done = true;
+  }
+  changed.notify_all();
+}
+
+// Give back the slot just read and wait for the next one
+PipelinedBuf::int_type PipelinedBuf::underflow () {
+  std::unique_lock<std::mutex> guard( lock );
+  if ( reading ) {
+    consumed++;
+    reading = false;
+    changed.notify_all();
+  }
+  changed.wait( guard, [this] { return produced > consumed || done; } );
+  if ( produced == consumed ) {
+    setg( NULL, NULL, NULL );
+    return traits_type::eof();
+  }
+  reading = true;
+  char* base = &slots[ consumed % INPUT_RING_SLOTS ][0];
+  setg( base, base, base + filled[ consumed % INPUT_RING_SLOTS ] );
+  return traits_type::to_int_type( *base );
+}
+
+InputFile::InputFile () : std::istream( NULL ), opened( false ) {
+  rdbuf( &buf );
+}
+
+bool InputFile::open ( const std::string& path ) {
+  int fd = path == "-" ? 0 : ::open( path.c_str(), O_RDONLY );
+  opened = fd >= 0 && buf.open( fd, path != "-" );
+  return opened;
+}
@@ -0,0 +1,77 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// The reader thread fills a ring of INPUT_RING_SLOTS buffers of
+// INPUT_BUFFER_SIZE bytes ahead of the parser, reading compressed input in
+// INPUT_READ_SIZE blocks
+#define INPUT_RING_SLOTS 4
+#define INPUT_BUFFER_SIZE ( 1 << 20 )
+#define INPUT_READ_SIZE ( 1 << 18 )
+
+struct Decoder;
+
+// Stream buffer over a file descriptor whose content is read, and
+// decompressed if it is gzip, xz or bzip2 data, on a separate thread. The
+// format is told by the first bytes, so pipes work as well as files. The
+// parser reads one slot of the ring while the thread fills the others.
+class PipelinedBuf : public std::streambuf {
+  public:
+    PipelinedBuf ();
+    ~PipelinedBuf ();
+    bool open ( int fd, bool ownsFd );
+    void close ();
+    const char* format () const { return formatName; }
+    const std::string& error () const { return errorText; }
+  protected:
+    int_type underflow ();
+  private:
+    int fd;
+    bool ownsFd;
+    const char* formatName;
+    std::string errorText; // set by the thread once it has stopped
+    // compressed input not yet decoded, in[inPos..inEnd)
+    std::vector<char> in;
+    size_t inPos;
+    size_t inEnd;
+    bool inEof;
+    Decoder* decoder;
+    std::vector< std::vector<char> > slots;
+    std::vector<size_t> filled; // bytes of each slot
+    unsigned long long produced; // slots filled so far
+    unsigned long long consumed; // slots the parser is done with
+    bool reading; // the parser holds slot consumed % INPUT_RING_SLOTS
+    bool done; // no more slots will be filled
+    bool closing; // the parser stopped, the thread should too
+    std::mutex lock;
+    std::condition_variable changed;
+    std::thread reader;
+    void run ();
+    bool readInput ();
+    char* acquire ();
+    bool publish ( size_t size );
+};
+
+// Input stream of a DIMACS file, or of stdin for "-"
+class InputFile : public std::istream {
+  public:
+    InputFile ();
+    bool open ( const std::string& path );
+    bool is_open () const { return opened; }
+    const char* format () const { return buf.format(); }
+    // empty unless reading or decompressing failed, the stream then ends
+    // early; valid once the stream has ended
+    const std::string& error () const { return buf.error(); }
+  private:
+    PipelinedBuf buf;
+    bool opened;
+};
+
+#endif
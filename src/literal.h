@@ -0,0 +1,34 @@
+#ifndef LITERAL_H
+#define LITERAL_H
+
+#include <stdint.h>
+
+// Inside the search engines a literal is encoded as 2 * var + sign, with
+// sign 1 for a negated variable, so literals index arrays directly and
+// negation is a single xor. DIMACS literals are only used at the edges.
+
+#define VALUE_TRUE 1
+#define VALUE_FALSE -1
+#define VALUE_UNDEF 0
+
+inline int toLit ( int dimacs ) {
+  return dimacs > 0 ? 2 * dimacs : -2 * dimacs + 1;
+}
+
+inline int toDimacs ( int lit ) {
+  return ( lit & 1 ) ? -( lit >> 1 ) : lit >> 1;
+}
+
+inline int litVar ( int lit ) {
+  return lit >> 1;
+}
+
+inline int litNeg ( int lit ) {
+  return lit ^ 1;
+}
+
+inline bool litSign ( int lit ) {
+  return lit & 1;
+}
+
+#endif
@@ -0,0 +1,133 @@
+#include "localsearch.h"
+#include "literal.h"
+#include <vector>
+
+LocalSearch::LocalSearch () {
+  reset( 0, 0 );
+}
+
+LocalSearch::LocalSearch ( int n, unsigned int seed ) {
+  reset( n, seed );
+}
+
+void LocalSearch::reset ( int n, unsigned int seed ) {
+  numVars = n;
+  flips = 0;
+  rng.seed( seed );
+  lits.clear();
+  start.clear();
+  start.push_back( 0 );
+  occurs.resize( 2 * n + 2 );
+  for ( int i = 0; i < occurs.size(); i++ )
+    occurs[i].clear();
+}
+
+void LocalSearch::addClause ( const int* clause, int size ) {
+  int c = start.size() - 1;
+  for ( int i = 0; i < size; i++ ) {
+    lits.push_back( clause[i] );
+    occurs[ clause[i] ].push_back( c );
+  }
+  start.push_back( lits.size() );
+}
+
+void LocalSearch::flip ( int var ) {
+  int wasTrue = value[ var ] == VALUE_TRUE ? 2 * var : 2 * var + 1;
+  int nowTrue = litNeg( wasTrue );
+  value[ var ] = -value[ var ];
+  flips++;
+  std::vector<int>& lost = occurs[ wasTrue ];
+  for ( int i = 0; i < lost.size(); i++ ) {
+    int c = lost[i];
+    if ( --trueCount[c] == 0 ) {
+      unsatPos[c] = unsat.size();
+      unsat.push_back( c );
+    }
+  }
+  std::vector<int>& gained = occurs[ nowTrue ];
+  for ( int i = 0; i < gained.size(); i++ ) {
+    int c = gained[i];
+    if ( trueCount[c]++ == 0 ) {
+      int last = unsat.back();
+      unsat[ unsatPos[c] ] = last;
+      unsatPos[ last ] = unsatPos[c];
+      unsat.pop_back();
+      unsatPos[c] = -1;
+    }
+  }
+}
+
+// Walk from the given per-variable phases for at most maxFlips flips, or
+// until limits, which may be null, run out, and leave the best assignment
+// found in best. Returns its number of unsatisfied clauses.
+int LocalSearch::walk ( const std::vector<int8_t>* phases, unsigned long long maxFlips, SearchLimits* limits ) {
+  int numClauses = start.size() - 1;
+  value = *phases;
+  trueCount.assign( numClauses, 0 );
+  unsatPos.assign( numClauses, -1 );
+  unsat.clear();
+  for ( int c = 0; c < numClauses; c++ ) {
+    for ( int i = start[c]; i < start[c + 1]; i++ ) {
+      int lit = lits[i];
+      if ( value[ litVar( lit ) ] == ( litSign( lit ) ? VALUE_FALSE : VALUE_TRUE ) )
+        trueCount[c]++;
+    }
+    if ( trueCount[c] == 0 ) {
+      unsatPos[c] = unsat.size();
+      unsat.push_back( c );
+    }
+  }
+  // the flips since the best assignment are logged and undone at the end
+  // instead of copying the assignment on every improvement; once they
+  // outnumber the variables the best is copied out and logging stops until
+  // the next improvement
+  sinceBest.clear();
+  bool logging = true;
+  int bestUnsat = unsat.size();
+  unsigned long long limit = flips + maxFlips;
+  while ( !unsat.empty() && flips < limit ) {
+    if ( limits && flips % WALK_POLL_FLIPS == 0 && limits->expired() )
+      break;
+    int c = unsat[ rng() % unsat.size() ];
+    // break count: clauses whose only true literal would become false
+    int pick = -1;
+    int minBreak = -1;
+    for ( int i = start[c]; i < start[c + 1]; i++ ) {
+      int var = litVar( lits[i] );
+      int trueLit = value[ var ] == VALUE_TRUE ? 2 * var : 2 * var + 1;
+      int breaks = 0;
+      std::vector<int>& os = occurs[ trueLit ];
+      for ( int j = 0; j < os.size(); j++ )
+        if ( trueCount[ os[j] ] == 1 ) breaks++;
+      if ( minBreak < 0 || breaks < minBreak ) {
+        minBreak = breaks;
+        pick = var;
+      }
+    }
+    if ( minBreak > 0 && rng() % 1000 < WALK_NOISE )
+      pick = litVar( lits[ start[c] + rng() % ( start[c + 1] - start[c] ) ] );
+    flip( pick );
+    if ( unsat.size() < bestUnsat ) {
+      bestUnsat = unsat.size();
+      sinceBest.clear();
+      logging = true;
+    } else if ( logging ) {
+      sinceBest.push_back( pick );
+      if ( sinceBest.size() > numVars ) {
+        undoSinceBest();
+        logging = false;
+      }
+    }
+  }
+  if ( logging )
+    undoSinceBest();
+  return bestUnsat;
+}
+
+// best is the current assignment with the logged flips undone
+void LocalSearch::undoSinceBest () {
+  best = value;
+  for ( int i = 0; i < sinceBest.size(); i++ )
+    best[ sinceBest[i] ] = -best[ sinceBest[i] ];
+  sinceBest.clear();
+}
@@ -0,0 +1,41 @@
+#ifndef LOCALSEARCH_H
+#define LOCALSEARCH_H
+
+#include <vector>
+#include <random>
+#include <stdint.h>
+#include "budget.h"
+
+// probability, in thousandths, of a random walk step instead of a greedy one
+#define WALK_NOISE 567
+
+// a walk checks its limits every WALK_POLL_FLIPS flips
+#define WALK_POLL_FLIPS 4096
+
+// WalkSAT over a fixed set of clauses in encoded literals. The random source
+// is a seeded mt19937, so a walk with a flip budget is reproducible. reset
+// empties it for another set of clauses but keeps its buffers, so repeated
+// walks of one search do not allocate the occurrence lists again.
+struct LocalSearch {
+  int numVars;
+  std::vector<int> lits; // literals of clause c in lits[start[c]..start[c + 1])
+  std::vector<int> start;
+  std::vector< std::vector<int> > occurs; // clauses containing each literal
+  std::vector<int> trueCount; // true literals per clause
+  std::vector<int> unsat; // clauses with no true literal
+  std::vector<int> unsatPos; // position in unsat, -1 if satisfied
+  std::vector<int8_t> value; // per variable, VALUE_TRUE or VALUE_FALSE
+  std::vector<int8_t> best; // assignment with the fewest unsat clauses seen
+  std::vector<int> sinceBest; // flips since the best, at most numVars of them
+  std::mt19937 rng;
+  unsigned long long flips;
+  LocalSearch ();
+  LocalSearch ( int numVars, unsigned int seed );
+  void reset ( int numVars, unsigned int seed );
+  void addClause ( const int* clause, int size );
+  int walk ( const std::vector<int8_t>* phases, unsigned long long maxFlips, SearchLimits* limits );
+  void flip ( int var );
+  void undoSinceBest ();
+};
+
+#endif
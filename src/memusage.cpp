@@ -0,0 +1,58 @@
+#include "memusage.h"
+
+size_t formulaBytes ( CDCLSolver* solver ) {
+  size_t bytes = vectorBytes( solver->formula ) + vectorBytes( solver->clauses );
+  for ( size_t i = 0; i < solver->formula.size(); i++ )
+    bytes += vectorBytes( solver->formula[i].vars ) + vectorBytes( solver->formula[i].polarity );
+  bytes += vectorBytes( solver->xors ) + vectorBytes( solver->cards );
+  for ( size_t i = 0; i < solver->xors.size(); i++ )
+    bytes += vectorBytes( solver->xors[i].vars );
+  for ( size_t i = 0; i < solver->cards.size(); i++ )
+    bytes += vectorBytes( solver->cards[i].vars ) + vectorBytes( solver->cards[i].polarity );
+  const XorMatrix& m = solver->xorMatrix;
+  bytes += vectorBytes( m.colVar ) + vectorBytes( m.varCol ) + vectorBytes( m.rows )
+    + vectorBytes( m.rhs ) + vectorBytes( m.pivot ) + vectorBytes( m.watch )
+    + vectorBytes( m.pivotRow ) + listBytes( m.watchers ) + vectorBytes( m.listed )
+    + vectorBytes( m.resolved ) + listBytes( m.resolvedAt ) + vectorBytes( m.queued )
+    + vectorBytes( m.queue ) + vectorBytes( m.assigned ) + vectorBytes( m.isTrue );
+  const CardSet& cs = solver->cardSet;
+  bytes += vectorBytes( cs.lits ) + vectorBytes( cs.start ) + vectorBytes( cs.bound )
+    + vectorBytes( cs.count ) + listBytes( cs.occurs );
+  return bytes;
+}
+
+void measureMemory ( CDCLSolver* solver, size_t* bytes ) {
+  size_t originalArena = solver->originalWords * sizeof( int );
+  bytes[ MEMORY_ORIGINAL ] = solver->formulaBytes + originalArena;
+  // everything else in the arena: learned and derived clauses, removed
+  // clauses not yet collected and spare capacity
+  bytes[ MEMORY_LEARNED ] = vectorBytes( solver->db.memory ) - originalArena
+    + vectorBytes( solver->learnts ) + vectorBytes( solver->detachedClauses )
+    + vectorBytes( solver->blocking );
+  bytes[ MEMORY_WATCHES ] = listBytes( solver->watches ) + listBytes( solver->binaries );
+  const VarData& vars = solver->vars;
+  bytes[ MEMORY_TRAIL ] = vectorBytes( solver->trail ) + vectorBytes( solver->trailLimits )
+    + vectorBytes( solver->values ) + vectorBytes( solver->sigma )
+    + vectorBytes( vars.level ) + vectorBytes( vars.reason ) + vectorBytes( vars.position )
+    + solver->decisionStack.size() * sizeof( decision );
+  bytes[ MEMORY_HEURISTICS ] = vectorBytes( vars.phase ) + vectorBytes( vars.heapIndex )
+    + vectorBytes( vars.activity ) + vectorBytes( vars.heap )
+    + vectorBytes( solver->seen ) + vectorBytes( solver->levelStamp )
+    + vectorBytes( solver->gaussLits )
+    + vectorBytes( solver->cardSet.reasonLits ) + vectorBytes( solver->cardSet.trueLits )
+    + vectorBytes( solver->dropped );
+  const LocalSearch& ls = solver->walker;
+  bytes[ MEMORY_HEURISTICS ] += vectorBytes( ls.lits ) + vectorBytes( ls.start ) + listBytes( ls.occurs )
+    + vectorBytes( ls.trueCount ) + vectorBytes( ls.unsat ) + vectorBytes( ls.unsatPos )
+    + vectorBytes( ls.value ) + vectorBytes( ls.best ) + vectorBytes( ls.sinceBest );
+}
+
+size_t recordMemory ( CDCLSolver* solver ) {
+  size_t bytes[ MEMORY_KINDS ];
+  measureMemory( solver, bytes );
+  solver->stats->recordMemory( bytes );
+  size_t total = 0;
+  for ( int k = 0; k < MEMORY_KINDS; k++ )
+    total += bytes[k];
+  return total;
+}
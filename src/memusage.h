@@ -0,0 +1,39 @@
+#ifndef MEMUSAGE_H
+#define MEMUSAGE_H
+
+#include <vector>
+#include <stddef.h>
+#include "cdcl.h"
+
+// Memory accounting of the CDCL search. Containers are measured by their
+// capacity, so the figures are what the search holds rather than what it
+// uses, and are split into the MEMORY_* subsystems of stats.h.
+
+template<typename T>
+inline size_t vectorBytes ( const std::vector<T>& v ) {
+  return v.capacity() * sizeof( T );
+}
+
+inline size_t vectorBytes ( const std::vector<bool>& v ) {
+  return v.capacity() / 8;
+}
+
+template<typename T>
+inline size_t listBytes ( const std::vector< std::vector<T> >& lists ) {
+  size_t bytes = vectorBytes( lists );
+  for ( size_t i = 0; i < lists.size(); i++ )
+    bytes += vectorBytes( lists[i] );
+  return bytes;
+}
+
+// Bytes of the parsed formula and the constraint structures built from it,
+// which do not change during the search. Called once the search is set up.
+size_t formulaBytes ( CDCLSolver* solver );
+
+// Current bytes of every subsystem, indexed by MEMORY_*
+void measureMemory ( CDCLSolver* solver, size_t* bytes );
+
+// Measure and record in the statistics; returns the total bytes
+size_t recordMemory ( CDCLSolver* solver );
+
+#endif
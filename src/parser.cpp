@@ -1,28 +1,33 @@
 #include <iostream>
 #include <fstream>
 #include <stdlib.h>
+#include <stdint.h>
 #include "solver.h"
 #include "parser.h"
 #include "dpll.h"
+#include "cardinality.h"
+#include "input.h"
+#include "perfcounters.h"
 #include <sstream>
 #include <iterator>
 #include <string>
 #include <vector>
 #include <stack>
+#include <algorithm>
 
 using namespace std;
 
 // Helper to print the solver's formula, used for debugging parsing
 void printFormula (Solver* s) {
-  std::vector<Clause> cVec = s->formula;
+  const std::vector<Clause>& cVec = s->formula;
   int clauses = s->numClauses;
   int vars = s->numVars;
   std::cout << "Printing formula with " << clauses << " clauses and " << vars << " variables\n";
   for ( int i = 0; i < clauses; i++) {
     int vs = cVec[i].numVars;
     std::cout << "clause " << i << " with " << vs << " variables: ";
-    std::vector<unsigned int> vars = cVec[i].vars;
-    std::vector<bool> isNeg = cVec[i].polarity;
+    const std::vector<unsigned int>& vars = cVec[i].vars;
+    const std::vector<bool>& isNeg = cVec[i].polarity;
     int numv = cVec[i].numVars;
     for ( int j = 0; j < numv; j++ ) {
       if ( isNeg[j] )
@@ -42,104 +47,242 @@ void reindexClauses( Solver* solver ) {
 }
 
 
-// Parse SAT problem in DIMACS format.
+// Find the XORs whose complete CNF encoding is among the clauses: for k
+// variables, all 2^(k - 1) sign patterns with the same parity of negations.
+// Those clauses forbid the assignments of that parity, so the variables sum
+// to the opposite one. The clauses themselves are kept.
+// a clause of 3 to XOR_MAX_RECOVER distinct variables, by its sorted
+// variables, sign pattern and negation parity
+struct XorCandidate {
+  unsigned int vars[ XOR_MAX_RECOVER ];
+  int size;
+  uint32_t signs;
+  int parity;
+  bool operator< ( const XorCandidate& o ) const {
+    return std::lexicographical_compare( vars, vars + size, o.vars, o.vars + o.size );
+  }
+  bool sameVars ( const XorCandidate& o ) const {
+    return size == o.size && std::equal( vars, vars + size, o.vars );
+  }
+};
+
+void recoverXors ( std::vector<Clause>* form, std::vector<Xor>* xors ) {
+  // candidates sorted by variable set; the sign patterns of one set, split
+  // by negation parity, fit in a word with at most 5 variables
+  std::vector<XorCandidate> candidates;
+  std::pair<unsigned int, bool> sorted[ XOR_MAX_RECOVER ];
+  for ( int i = 0; i < form->size(); i++ ) {
+    Clause* c = &( *form )[i];
+    if ( c->numVars < 3 || c->numVars > XOR_MAX_RECOVER )
+      continue;
+    for ( int j = 0; j < c->numVars; j++ )
+      sorted[j] = std::make_pair( c->vars[j], c->polarity[j] );
+    std::sort( sorted, sorted + c->numVars );
+    XorCandidate x;
+    x.size = 0;
+    x.signs = 0;
+    x.parity = 0;
+    for ( int j = 0; j < c->numVars; j++ ) {
+      if ( j > 0 && sorted[j].first == sorted[j - 1].first )
+        break; // repeated variable
+      x.vars[ x.size++ ] = sorted[j].first;
+      x.signs |= (uint32_t) sorted[j].second << j;
+      x.parity ^= sorted[j].second;
+    }
+    if ( x.size == c->numVars )
+      candidates.push_back( x );
+  }
+  std::sort( candidates.begin(), candidates.end() );
+  for ( size_t i = 0; i < candidates.size(); ) {
+    uint32_t seen[2] = { 0, 0 };
+    size_t j = i;
+    for ( ; j < candidates.size() && candidates[j].sameVars( candidates[i] ); j++ )
+      seen[ candidates[j].parity ] |= 1u << candidates[j].signs;
+    int half = 1 << ( candidates[i].size - 1 );
+    std::vector<unsigned int> vars( candidates[i].vars, candidates[i].vars + candidates[i].size );
+    if ( __builtin_popcount( seen[0] ) == half )
+      xors->push_back( { vars, true, true } );
+    if ( __builtin_popcount( seen[1] ) == half )
+      xors->push_back( { vars, false, true } );
+    i = j;
+  }
+}
+
+// Parse SAT problem in DIMACS format from a file, plain or compressed, or
+// from stdin for "-".
 bool simpleParse (Solver* solver, char* filename) {
-  ifstream file ( filename );
+  InputFile file;
+  if ( !file.open( filename ) ) {
+    std::cout << "Invalid filename: " << filename << "\n";
+    return false;
+  }
+  bool parsed = parseDimacs( solver, file );
+  if ( parsed && !file.error().empty() ) {
+    std::cerr << "Cannot read " << filename << ": " << file.error() << "\n";
+    return false;
+  }
+  return parsed;
+}
+
+// Parse SAT problem in DIMACS format from an open stream.
+bool parseDimacs (Solver* solver, std::istream& file) {
+  timePoint start = now();
+  PerfCounters* counters = solver->stats ? solver->counters : nullptr;
+  unsigned long long phaseStart[ PERF_COUNTERS ];
+  bool counted = phaseBegin( counters, phaseStart );
   string line = "c";
   int vars = 0;
   int clauses = 0;
   std::vector<bool> isPure;
   std::vector<int> lastPolarity;
+  solver->sigmaStack.clear();
+  solver->xors.clear();
+  solver->cards.clear();
+  solver->numAssigned = 0;
 
-  
-  if ( file.is_open() ) {
-    // parse (consume) comments
-    while ( line[0] == 'c' && file ) {
-      getline ( file, line ); 
-    }
-    // parse problem statement
-    if ( line[0] == 'p' ) {
-      std::istringstream iss( line );
-      std::vector<std::string> tokens( ( std::istream_iterator<std::string>( iss ) ),
-              std::istream_iterator<std::string>() );
-      vars = stoi( tokens[2] );
-      clauses = stoi( tokens[3] );
-      getline( file, line );
+  // parse (consume) comments
+  while ( line[0] == 'c' && file ) {
+    getline ( file, line ); 
+  }
+  // parse problem statement
+  if ( line[0] == 'p' ) {
+    std::istringstream iss( line );
+    std::string p, format;
+    if ( !( iss >> p >> format >> vars >> clauses ) || vars < 0 ) {
+      std::cerr << "Invalid problem line: " << line << "\n";
+      return false;
     }
+    getline( file, line );
+  }
 
-    solver->numClauses = clauses;
-    solver->numVars = vars;
-    solver->sigma = std::vector<int> ( vars + 1, 0 ); 
-    isPure = std::vector<bool> (vars + 1, true);
-    isPure[0] = false; // Since isPure is indexed by literals, which start at 1
-    // with lastPolarity, 0 means the variable hasn't been processed yet
-    // -1 means -, 1 means +. 
-    lastPolarity = std::vector<int> (vars + 1, 0);
-    // parse clauses:
-    std::vector<Clause> form;
-    while ( file ) {
-      std::vector<unsigned int> parsedVars;
-      std::vector<bool> polarity;
-      std::stringstream iss( line );
-      int v;
-      int numv = 0;
-      int temp;
-      int absVar;
-      while ( iss >> v ) {
-        if ( v != 0 ) {
-          absVar = abs ( v );
-          temp = v < 0 ? -1 : 1;
-          if ( ( lastPolarity[absVar] != 0 ) && ( temp != lastPolarity[absVar] ) ) {
-            isPure[absVar] = false;
-          }
-          lastPolarity[absVar] = temp;
-          polarity.push_back( v < 0 );
-          parsedVars.push_back( absVar );
-          numv++;
+  solver->numClauses = clauses;
+  solver->numVars = vars;
+  solver->sigma = std::vector<int> ( vars + 1, 0 ); 
+  isPure = std::vector<bool> (vars + 1, true);
+  isPure[0] = false; // Since isPure is indexed by literals, which start at 1
+  // with lastPolarity, 0 means the variable hasn't been processed yet
+  // -1 means -, 1 means +. 
+  lastPolarity = std::vector<int> (vars + 1, 0);
+  // parse clauses:
+  std::vector<Clause> form;
+  // one line stream and literal buffers for the whole file; a constraint
+  // takes an exactly sized copy of the literals of its line
+  std::stringstream iss;
+  std::vector<unsigned int> parsedVars;
+  std::vector<bool> polarity;
+  while ( file ) {
+    // SATLIB files end with a "%" line and a stray "0"
+    if ( line[0] == '%' )
+      break;
+    parsedVars.clear();
+    polarity.clear();
+    iss.clear();
+    iss.str( line );
+    // "x l1 l2 ... 0" is an XOR of literals that must be true
+    bool isXor = line[0] == 'x';
+    if ( isXor )
+      iss.ignore( 1 );
+    // "l1 l2 ... <= k" and "l1 l2 ... >= k" bound how many literals are true
+    bool isCard = line.find( "<=" ) != string::npos || line.find( ">=" ) != string::npos;
+    int v;
+    int numv = 0;
+    int temp;
+    int absVar;
+    bool terminated = false;
+    while ( iss >> v ) {
+      terminated = v == 0;
+      if ( v != 0 ) {
+        absVar = abs ( v );
+        if ( absVar > vars ) {
+          std::cerr << "Variable " << absVar << " exceeds the problem line\n";
+          return false;
         }
+        temp = v < 0 ? -1 : 1;
+        if ( isXor || isCard || ( ( lastPolarity[absVar] != 0 ) && ( temp != lastPolarity[absVar] ) ) ) {
+          isPure[absVar] = false;
+        }
+        lastPolarity[absVar] = temp;
+        polarity.push_back( v < 0 );
+        parsedVars.push_back( absVar );
+        numv++;
       }
-      if ( numv > 0 ) { // ensures empty lines at end will not cause seg fault
-        Clause clause ( &parsedVars, &polarity, numv, form.size() );
-        form.push_back ( clause );
-      }
-      getline ( file, line );
     }
-    // remove pure literals and update sigma
-    std::vector<int> pureLits;
-    int numPureLits = 0;
-    for( int i = 1; i < vars + 1; i++ ) {
-      if( isPure[i] ) {
-        pureLits.push_back(i);
-        solver->sigma[i] = ( lastPolarity[i] == 1 ? 1 : -1 );
-        solver->sigmaStack.push_back( i );
-        (solver->numAssigned)++;
-        numPureLits++;
+    if ( isCard ) {
+      std::string op;
+      int bound;
+      iss.clear();
+      if ( !( iss >> op >> bound ) || ( op != "<=" && op != ">=" ) ) {
+        std::cerr << "Invalid cardinality constraint: " << line << "\n";
+        return false;
       }
-    }
-    int i = 0;
-    while( i < clauses ) {
-      for( int j = 0; j < numPureLits; j++ ) {
-        if ( i >= clauses ) break; 
-        if ( form[i].hasLit( pureLits[j] ) ) {
-          form.erase( form.begin() + i );
-          clauses--;
-          solver->numClauses = clauses;
-          continue;
-        }
+      // at least k of n literals is at most n - k of their negations
+      if ( op == ">=" ) {
+        bound = numv - bound;
+        for ( int j = 0; j < numv; j++ )
+          polarity[j] = !polarity[j];
+      }
+      Card card = { parsedVars, polarity, bound, false };
+      solver->cards.push_back( std::move( card ) );
+    } else if ( isXor ) {
+      // negations flip the sum, and a variable occurring twice cancels out
+      Xor x = { std::vector<unsigned int>(), true, false };
+      for ( int j = 0; j < numv; j++ )
+        x.rhs ^= polarity[j];
+      std::sort( parsedVars.begin(), parsedVars.end() );
+      for ( int j = 0; j < numv; j++ ) {
+        if ( j + 1 < numv && parsedVars[j] == parsedVars[j + 1] )
+          j++;
         else
-          i++;
+          x.vars.push_back( parsedVars[j] );
       }
-      i++;
+      solver->xors.push_back( std::move( x ) );
+    } else if ( numv > 0 || terminated ) {
+      // a 0 on its own is the empty clause, only blank lines are skipped
+      form.push_back( Clause( parsedVars, polarity, numv, form.size() ) );
     }
-    solver->formula = form;
-    reindexClauses( solver );
-    return true; 
+    getline ( file, line );
   }
-
-  else {
-    std::cout << "Invalid filename: " << filename << "\n";
-    return false;
+  // x-lines and cardinality lines count towards the clauses of the problem line
+  clauses = form.size();
+  solver->numClauses = clauses;
+  if ( solver->stats )
+    solver->stats->parseTime += secondsSince( start );
+  phaseEnd( counters, counted, phaseStart, solver->stats, PHASE_PARSE );
+  timePoint preprocessStart = now();
+  counted = phaseBegin( counters, phaseStart );
+  recoverXors( &form, &solver->xors );
+  recoverCards( &form, &solver->cards );
+  // remove pure literals and update sigma; that keeps satisfiability but
+  // not the set of models, so enumeration turns it off
+  if ( !solver->eliminatePure )
+    std::fill( isPure.begin(), isPure.end(), false );
+  for( int i = 1; i < vars + 1; i++ ) {
+    if( isPure[i] ) {
+      solver->sigma[i] = ( lastPolarity[i] == 1 ? 1 : -1 );
+      solver->sigmaStack.push_back( i );
+      (solver->numAssigned)++;
+    }
+  }
+  // drop the clauses satisfied by a pure literal in one compacting pass
+  size_t kept = 0;
+  for ( size_t i = 0; i < form.size(); i++ ) {
+    bool satisfied = false;
+    for ( int j = 0; j < form[i].numVars && !satisfied; j++ )
+      satisfied = isPure[ form[i].vars[j] ];
+    if ( !satisfied ) {
+      if ( kept != i )
+        form[ kept ] = std::move( form[i] );
+      kept++;
+    }
   }
+  form.erase( form.begin() + kept, form.end() );
+  solver->numClauses = form.size();
+  solver->formula.swap( form );
+  reindexClauses( solver );
+  if ( solver->stats )
+    solver->stats->preprocessTime += secondsSince( preprocessStart );
+  phaseEnd( counters, counted, phaseStart, solver->stats, PHASE_PREPROCESS );
+  return true; 
 }
 
 // parsing function for DPLL: more complex than basic parsing above, includes
@@ -1,8 +1,18 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <istream>
+#include "solver.h"
+
+// XORs of 3 to XOR_MAX_RECOVER variables are recovered from their CNF
+// encoding, which takes 2^(k - 1) clauses each; at most 5
+#define XOR_MAX_RECOVER 5
+
+// filename may be "-" for stdin; gzip, xz and bzip2 input is decompressed
 bool simpleParse (Solver* solver, char* filename); 
 
+bool parseDimacs (Solver* solver, std::istream& file);
+
 void parse (Solver* solver, char* filename);
 
 #endif
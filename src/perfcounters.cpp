@@ -0,0 +1,146 @@
+#include "perfcounters.h"
+#include <errno.h>
+#include <string.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+PerfCounters::PerfCounters () {
+  for ( int k = 0; k < PERF_COUNTERS; k++ ) {
+    fds[k] = -1;
+    slot[k] = -1;
+  }
+  leader = -1;
+  members = 0;
+  available = 0;
+  status = "off";
+  enabledTime = 0;
+  runningTime = 0;
+}
+
+PerfCounters::~PerfCounters () {
+  close();
+}
+
+#ifdef __linux__
+
+// type and config of each PERF_* counter
+static const unsigned int counterTypes[ PERF_COUNTERS ] = {
+  PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE
+};
+static const unsigned long long counterConfigs[ PERF_COUNTERS ] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES,
+  PERF_COUNT_HW_CACHE_L1D | ( PERF_COUNT_HW_CACHE_OP_READ << 8 ) | ( PERF_COUNT_HW_CACHE_RESULT_MISS << 16 )
+};
+
+static const char* openError ( int error ) {
+  switch ( error ) {
+    case ENOENT:
+    case ENODEV:
+    case EOPNOTSUPP:
+      return "hardware counters not supported here";
+    case EACCES:
+    case EPERM:
+      return "not permitted, see kernel.perf_event_paranoid";
+    case ENOSYS:
+      return "perf_event_open not available";
+    case EMFILE:
+      return "too many open files";
+    default:
+      return "cannot open hardware counters";
+  }
+}
+
+bool PerfCounters::open () {
+  close();
+  int error = 0;
+  for ( int k = 0; k < PERF_COUNTERS; k++ ) {
+    struct perf_event_attr attr;
+    memset( &attr, 0, sizeof( attr ) );
+    attr.size = sizeof( attr );
+    attr.type = counterTypes[k];
+    attr.config = counterConfigs[k];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // this thread on any CPU; the first counter that opens leads the group
+    int fd = syscall( SYS_perf_event_open, &attr, 0, -1, leader, 0 );
+    if ( fd < 0 ) {
+      if ( !error )
+        error = errno;
+      continue;
+    }
+    if ( leader < 0 )
+      leader = fd;
+    fds[k] = fd;
+    slot[k] = members++;
+    available |= 1 << k;
+  }
+  if ( !members ) {
+    status = openError( error );
+    return false;
+  }
+  status = "on";
+  return true;
+}
+
+bool PerfCounters::read ( unsigned long long* values ) {
+  for ( int k = 0; k < PERF_COUNTERS; k++ )
+    values[k] = 0;
+  if ( !members )
+    return false;
+  // nr, time enabled, time running, then one value per member
+  unsigned long long data[ 3 + PERF_COUNTERS ];
+  size_t size = ( 3 + members ) * sizeof( unsigned long long );
+  if ( ::read( leader, data, size ) != (ssize_t) size )
+    return false;
+  enabledTime = data[1];
+  runningTime = data[2];
+  for ( int k = 0; k < PERF_COUNTERS; k++ ) {
+    if ( slot[k] >= 0 )
+      values[k] = data[ 3 + slot[k] ];
+  }
+  return true;
+}
+
+void PerfCounters::close () {
+  for ( int k = 0; k < PERF_COUNTERS; k++ ) {
+    if ( fds[k] >= 0 )
+      ::close( fds[k] );
+    fds[k] = -1;
+    slot[k] = -1;
+  }
+  leader = -1;
+  members = 0;
+  available = 0;
+}
+
+#else
+
+bool PerfCounters::open () {
+  status = "hardware counters need Linux";
+  return false;
+}
+
+bool PerfCounters::read ( unsigned long long* values ) {
+  for ( int k = 0; k < PERF_COUNTERS; k++ )
+    values[k] = 0;
+  return false;
+}
+
+void PerfCounters::close () {
+}
+
+#endif
+
+void PerfCounters::report ( SolverStats* stats ) {
+  stats->countersStatus = status;
+  stats->countersAvailable |= available;
+  stats->countersEnabled += enabledTime;
+  stats->countersRunning += runningTime;
+}
@@ -0,0 +1,49 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include "stats.h"
+
+// Hardware counters of one thread, opened as a perf_event_open group on
+// Linux so that all of them are read together by one read(). Each phase is
+// counted by reading the group before and after it and adding the
+// difference to the phase's row in the stats; a phase costs two system
+// calls, so the counters are only opened when asked for. Counters the CPU
+// or kernel does not offer are left out of the group, and when none can be
+// opened status says why and nothing is counted.
+struct PerfCounters {
+  int fds[ PERF_COUNTERS ]; // -1 for a counter that is not open
+  int slot[ PERF_COUNTERS ]; // position of the counter in a group read
+  int leader; // fd the group is read from, -1 when none is open
+  int members;
+  int available; // bit 1 << PERF_* for each open counter
+  const char* status; // "on", or why no counter could be opened
+  unsigned long long enabledTime; // ns the group was enabled, at the last read
+  unsigned long long runningTime; // ns it was on the PMU, less if multiplexed
+  PerfCounters ();
+  ~PerfCounters ();
+  bool open ();
+  void close ();
+  // current value of every counter, 0 for those not open
+  bool read ( unsigned long long* values );
+  // add the availability and scheduling of this thread's counters to the
+  // report, so that the groups of several threads merge into one
+  void report ( SolverStats* stats );
+};
+
+// Counting one phase: phaseBegin returns whether the start was read, and
+// phaseEnd only adds a difference when it was; a null group counts nothing
+inline bool phaseBegin ( PerfCounters* counters, unsigned long long* start ) {
+  return counters && counters->read( start );
+}
+
+inline void phaseEnd ( PerfCounters* counters, bool started, const unsigned long long* start, SolverStats* stats, int phase ) {
+  if ( !started )
+    return;
+  unsigned long long end[ PERF_COUNTERS ];
+  if ( !counters->read( end ) )
+    return;
+  for ( int k = 0; k < PERF_COUNTERS; k++ )
+    stats->phaseCounters[ phase ][k] += end[k] - start[k];
+}
+
+#endif
@@ -0,0 +1,111 @@
+#include "presets.h"
+#include <sstream>
+#include <stdlib.h>
+
+// Small random formulas near the threshold go to the lookahead DPLL solver,
+// mostly binary (structured) ones to CDCL without local search, which
+// rarely helps on them.
+static const char* builtinPresets =
+  "small-random  engine=dpll            vars<=150 min_clause_size>=3 max_clause_size<=3 ratio>=3.8 ratio<=4.6 xors==0 cards==0\n"
+  "structured    engine=cdcl walk=0     binary_fraction>=0.5\n"
+  "uniform       engine=cdcl walk=5     max_clause_size<=7 degree_cv<=0.35\n"
+  "default       engine=cdcl\n";
+
+Preset::Preset () {
+  walkInterval = PRESET_UNSET;
+  chronoThreshold = PRESET_UNSET;
+  threads = PRESET_UNSET;
+}
+
+bool Preset::matches ( const Features* features ) const {
+  for ( int i = 0; i < conditions.size(); i++ ) {
+    const PresetCondition& c = conditions[i];
+    double x;
+    if ( !featureValue( features, c.feature, &x ) )
+      return false;
+    bool holds = c.op == "<" ? x < c.value : c.op == "<=" ? x <= c.value
+      : c.op == ">" ? x > c.value : c.op == ">=" ? x >= c.value : x == c.value;
+    if ( !holds )
+      return false;
+  }
+  return true;
+}
+
+// Parse an integer setting, false unless the whole value is a number
+bool presetInt ( const std::string& value, int* out ) {
+  char* end;
+  long x = strtol( value.c_str(), &end, 10 );
+  if ( value.empty() || *end )
+    return false;
+  *out = x;
+  return true;
+}
+
+bool parsePresets ( std::istream& in, std::vector<Preset>* presets, std::string* error ) {
+  std::string line;
+  Features probe = Features();
+  for ( int lineNumber = 1; getline( in, line ); lineNumber++ ) {
+    size_t hash = line.find( '#' );
+    if ( hash != std::string::npos )
+      line.erase( hash );
+    std::istringstream tokens( line );
+    Preset preset;
+    if ( !( tokens >> preset.name ) )
+      continue;
+    std::string token;
+    bool valid = true;
+    while ( valid && tokens >> token ) {
+      size_t opStart = token.find_first_of( "<>=" );
+      if ( opStart == std::string::npos || opStart == 0 ) {
+        valid = false;
+        break;
+      }
+      size_t opEnd = token.find_first_not_of( "<>=", opStart );
+      std::string key = token.substr( 0, opStart );
+      std::string op = token.substr( opStart, opEnd == std::string::npos ? std::string::npos : opEnd - opStart );
+      std::string value = opEnd == std::string::npos ? "" : token.substr( opEnd );
+      if ( op == "=" ) {
+        if ( key == "engine" ) {
+          preset.engine = value;
+          valid = value == "cdcl" || value == "dpll";
+        } else if ( key == "walk" )
+          valid = presetInt( value, &preset.walkInterval );
+        else if ( key == "chrono" )
+          valid = presetInt( value, &preset.chronoThreshold );
+        else if ( key == "threads" )
+          valid = presetInt( value, &preset.threads );
+        else
+          valid = false;
+      } else {
+        char* end;
+        double x = strtod( value.c_str(), &end );
+        double known;
+        valid = !value.empty() && !*end && featureValue( &probe, key, &known )
+          && ( op == "<" || op == "<=" || op == ">" || op == ">=" || op == "==" );
+        preset.conditions.push_back( { key, op, x } );
+      }
+    }
+    if ( !valid ) {
+      std::ostringstream message;
+      message << "line " << lineNumber << ": cannot read " << token;
+      *error = message.str();
+      return false;
+    }
+    presets->push_back( preset );
+  }
+  return true;
+}
+
+void defaultPresets ( std::vector<Preset>* presets ) {
+  std::istringstream in( builtinPresets );
+  std::string error;
+  parsePresets( in, presets, &error );
+}
+
+const Preset* selectPreset ( const std::vector<Preset>* presets, const Features* features ) {
+  for ( int i = 0; i < presets->size(); i++ ) {
+    if ( ( *presets )[i].matches( features ) )
+      return &( *presets )[i];
+  }
+  return nullptr;
+}
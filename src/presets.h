@@ -0,0 +1,44 @@
+#ifndef PRESETS_H
+#define PRESETS_H
+
+#include <string>
+#include <vector>
+#include <istream>
+#include "formulafeatures.h"
+
+// marks a preset setting that leaves the option as it is
+#define PRESET_UNSET -1000000
+
+// A named configuration applied when every condition on the features
+// holds. Settings left unset keep their command line or built-in value.
+struct PresetCondition {
+  std::string feature;
+  std::string op; // one of < <= > >= ==
+  double value;
+};
+
+struct Preset {
+  std::string name;
+  std::string engine; // cdcl or dpll, empty to leave it
+  int walkInterval;
+  int chronoThreshold;
+  int threads;
+  std::vector<PresetCondition> conditions;
+  Preset ();
+  bool matches ( const Features* features ) const;
+};
+
+// Preset table, one preset per line, '#' starts a comment:
+//   NAME [key=value ...] [feature<op>number ...]
+// with keys engine, walk, chrono and threads, feature names as in the
+// feature dump and op one of < <= > >= ==. The first preset whose
+// conditions all hold is used, so a line without conditions ends the
+// table. On error the message names the line.
+bool parsePresets ( std::istream& in, std::vector<Preset>* presets, std::string* error );
+
+// built-in table, used unless another is loaded
+void defaultPresets ( std::vector<Preset>* presets );
+
+const Preset* selectPreset ( const std::vector<Preset>* presets, const Features* features );
+
+#endif
@@ -5,74 +5,206 @@
 #include <time.h>
 #include <unistd.h>
 #include <string>
+#include <fstream>
+#include <memory>
+#include <string.h>
 #include <getopt.h>
 #include "solver.h"
 #include "parser.h"
 #include "dpll.h"
 #include "cdcl.h"
+#include "generators.h"
+#include "budget.h"
+#include "daemon.h"
+#include "formulafeatures.h"
+#include "presets.h"
+#include "enumerate.h"
+#include "perfcounters.h"
+#include <thread>
+#include <algorithm>
+#include <climits>
 
 using namespace std;
 
-// Randomly evaluate formula for 10 seconds
-void randomEval ( Solver solver, int timeout ) {
-  int numv = solver.numVars;
+// DPLL and random evaluation only see clauses; XORs and cardinality
+// constraints given as such have no clauses standing in for them
+bool clausesOnly ( Solver* solver ) {
+  for ( int i = 0; i < solver->xors.size(); i++ ) {
+    if ( !solver->xors[i].encoded ) {
+      std::cout << "XOR constraints need the CDCL engine\n";
+      return false;
+    }
+  }
+  for ( int i = 0; i < solver->cards.size(); i++ ) {
+    if ( !solver->cards[i].encoded ) {
+      std::cout << "Cardinality constraints need the CDCL engine\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// Randomly evaluate formula until a budget runs out, each assignment tried
+// counts as a decision. Variables the parser assigned as pure keep their
+// value, since the clauses they satisfy were removed.
+void randomEval ( Solver* solver, SearchLimits* limits ) {
+  SolverStats localStats;
+  if ( !solver->stats )
+    solver->stats = &localStats;
+  // no assignment satisfies an empty clause
+  for ( int i = 0; i < solver->numClauses; i++ ) {
+    if ( solver->formula[i].numVars == 0 ) {
+      solver->stats->result = "unsat";
+      std::cout << "UNSAT\n";
+      if ( solver->stats == &localStats )
+        solver->stats = nullptr;
+      return;
+    }
+  }
+  int numv = solver->numVars;
   long long int numAssignments = pow ( 2, numv );  
   if ( numAssignments < 0 ) {
     std::cout << "Random evaluation only appropriate for smaller problems (<63 variables)\n";
     std::cout << "Number possible assignments exceeds MAX_INT and it is impossible\nto track which assignments have been explored.\n";
     return;
   }
-  time_t end = time( NULL ) + timeout;
-  int assignmentsExplored = 0; 
-  bool* assignmentMap = (bool*) malloc ( sizeof( bool ) * numAssignments ); //maps assignments to integers by interpreting assignment as binary expression
-  for (int i = 0; i < numAssignments; i++) {
-    assignmentMap[i] = false;
-  }
+  std::vector<int> pure;
+  for ( int i = 0; i < solver->sigmaStack.size(); i++ )
+    pure.push_back( solver->sigma[ solver->sigmaStack[i] ] * solver->sigmaStack[i] );
+  long long int assignmentsExplored = 0;
+  std::vector<bool> assignmentMap( numAssignments, false ); //maps assignments to integers by interpreting assignment as binary expression
   long long int currentAssignment;
   srand( time( NULL ) );
-  // Loop for 10 seconds:
-  while ( time( NULL )  <= end ) {
-    currentAssignment = generateRandomAssignment( numv, &(solver.sigma) );
+  limits->begin();
+  solver->clear();
+  while ( !limits->exhausted( solver->stats ) ) {
+    solver->stats->decisions++;
+    currentAssignment = generateRandomAssignment( numv, &(solver->sigma) );
     if ( assignmentMap[currentAssignment] ) {
-      solver.clear();
+      solver->clear();
       continue;
     }
+    for ( int i = 0; i < pure.size(); i++ )
+      solver->sigma[ abs( pure[i] ) ] = pure[i] > 0 ? 1 : -1;
     assignmentsExplored++;
-    if ( evaluate( &solver ) ) {
+    if ( evaluate( solver ) ) {
+      solver->stats->result = "sat";
       std::cout << "SAT: explored " << assignmentsExplored << " out of " << numAssignments << " possibilities\n";
-      for ( int i = 0; i < solver.numVars; i++) {
-        std::cout << "Sigma(" << i + 1 << ")= " << solver.sigma[i] << "\n";
+      for ( int i = 1; i < solver->numVars + 1; i++) {
+        std::cout << "Sigma(" << i << ")= " << solver->sigma[i] << "\n";
       }
-      return;
+      break;
     } else if ( assignmentsExplored == numAssignments ) {
+      solver->stats->result = "unsat";
       std::cout << "UNSAT\n";
-      return;
+      break;
     }
     assignmentMap[currentAssignment] = true;
-    solver.clear();
+    solver->clear();
+  }
+  if ( limits->reason ) {
+    solver->stats->stopReason = limits->reason;
+    std::cout << "Unknown:\n";
+    std::cout << assignmentsExplored << " out of " << numAssignments << " possible assignments explored.\n";
+  }
+  if ( solver->stats == &localStats )
+    solver->stats = nullptr;
+}
+
+// Ranges of variables of a --project list such as "1,2,5-9" or "1 2 5-9",
+// kept as ranges until they can be checked against the problem line
+bool parseVarList ( const char* text, std::vector< std::pair<int, int> >* ranges ) {
+  const char* p = text;
+  while ( *p ) {
+    if ( *p == ',' || *p == ' ' ) {
+      p++;
+      continue;
+    }
+    char* end;
+    long first = strtol( p, &end, 10 );
+    long last = first;
+    if ( end == p || first < 1 || first > INT_MAX )
+      return false;
+    if ( *end == '-' ) {
+      p = end + 1;
+      last = strtol( p, &end, 10 );
+      if ( end == p || last < first || last > INT_MAX )
+        return false;
+    }
+    ranges->push_back( std::make_pair( (int) first, (int) last ) );
+    p = end;
   }
-  std::cout << "Unknown:\n";
-  std::cout << assignmentsExplored << " out of " << numAssignments << " possible assignments explored.\n";
+  return !ranges->empty();
 }
 
 void help () {
   std::cout << "Options: short flags are also acceptable\n";
   std::cout << "--time i    Sets time out to i seconds (default is 300)\n";
+  std::cout << "--conflicts n     Stop after n conflicts\n";
+  std::cout << "--propagations n  Stop after n propagations\n";
+  std::cout << "--decisions n     Stop after n decisions\n";
+  std::cout << "--mem m     Stop when resident memory exceeds m megabytes\n";
+  std::cout << "--mem-soft m  CDCL: drop learned clauses that are not glue when the search\n";
+  std::cout << "            holds more than m megabytes\n";
+  std::cout << "--walk n    CDCL: local search for phases every n restarts, 0 disables\n";
+  std::cout << "--chrono n  CDCL: backtrack one level instead of jumping over more than n, -1 disables\n";
+  std::cout << "--checkpoint f  CDCL: save learned clauses, units, activities and phases to f\n";
+  std::cout << "--resume f  CDCL: load a checkpoint written for the same formula before searching\n";
+  std::cout << "--trace f   CDCL: record search events to the binary file f, read with\n";
+  std::cout << "            tools/tracetool\n";
+  std::cout << "--all       CDCL: write every model as a v line, then the number found\n";
+  std::cout << "--project l CDCL: enumerate the models projected onto the variables of l,\n";
+  std::cout << "            e.g. 1,2,5-9; implies --all\n";
   std::cout << "--verbose   Verbose mode\n";
   std::cout << "--dpll      Use DPLL Solving algorithm\n"; 
   std::cout << "--rand      Randomly evaluate\n";
+  std::cout << "--stats     Print solver statistics as JSON to stderr on exit\n";
+  std::cout << "--perf      Read hardware counters (Linux) around parsing and the CDCL phases,\n";
+  std::cout << "            reported by --stats\n";
+  std::cout << "--generate s  Write a generated instance to stdout, see --generate help\n";
+  std::cout << "--serve p   Serve CDCL jobs on Unix socket p, or on stdin and stdout for -\n";
+  std::cout << "            (protocol in src/daemon.h); limits above are the job defaults\n";
+  std::cout << "--workers n Worker threads for --serve (default: number of cores)\n";
+  std::cout << "--threads n CDCL: solve independent components on n threads, 0 disables splitting\n";
+  std::cout << "--auto      Pick engine and settings from the formula's features; explicit\n";
+  std::cout << "            options win over the preset chosen\n";
+  std::cout << "--presets f Load the preset table for --auto from f (format in src/presets.h)\n";
+  std::cout << "--features f  Write the formula's features as JSON to f, - for stderr\n";
   std::cout << "--help      Get help\n";
 }
 
 // take file for input, run selected algorithm. 
 int main (int argc, char** argv) {
   char* satFile = NULL;
+  char* genSpec = NULL;
   int dpllFlag = 0;
   int cdclFlag = 0;
   int randFlag = 0;
   int c;
   int verbose = false;
-  int time = 300;
+  int statsFlag = 0;
+  int autoFlag = 0;
+  int allFlag = 0;
+  int perfFlag = 0;
+  std::vector< std::pair<int, int> > projection;
+  char* presetsFile = NULL;
+  char* featuresFile = NULL;
+  bool walkGiven = false;
+  bool chronoGiven = false;
+  bool threadsGiven = false;
+  int walkInterval = WALK_INTERVAL;
+  int chronoThreshold = CHRONO_THRESHOLD;
+  long memorySoftMB = 0;
+  std::string checkpointFile;
+  std::string resumeFile;
+  char* traceFile = NULL;
+  char* servePath = NULL;
+  int workers = std::thread::hardware_concurrency();
+  int threads = std::max( 1u, std::thread::hardware_concurrency() );
+  SearchLimits limits;
+  limits.timeout = 300;
+  int status;
+  SolverStats stats;
 
   if ( argc <= 1 ) {
     std::cout << "Please provide an input file and select an algorithm\n";
@@ -86,15 +218,36 @@ int main (int argc, char** argv) {
     { "cdcl", no_argument, &cdclFlag, 1 },
     { "rand", no_argument, &randFlag, 1 },
     { "random", no_argument, &randFlag, 1 },
+    { "stats", no_argument, &statsFlag, 1 },
+    { "auto", no_argument, &autoFlag, 1 },
+    { "all", no_argument, &allFlag, 1 },
+    { "perf", no_argument, &perfFlag, 1 },
     // options
     { "time", required_argument, 0, 't' },
+    { "generate", required_argument, 0, 'g' },
+    { "conflicts", required_argument, 0, 'C' },
+    { "propagations", required_argument, 0, 'P' },
+    { "decisions", required_argument, 0, 'D' },
+    { "mem", required_argument, 0, 'm' },
+    { "mem-soft", required_argument, 0, 'M' },
+    { "walk", required_argument, 0, 'w' },
+    { "chrono", required_argument, 0, 'b' },
+    { "checkpoint", required_argument, 0, 'k' },
+    { "resume", required_argument, 0, 'R' },
+    { "trace", required_argument, 0, 'X' },
+    { "serve", required_argument, 0, 'S' },
+    { "workers", required_argument, 0, 'W' },
+    { "threads", required_argument, 0, 'T' },
+    { "presets", required_argument, 0, 'L' },
+    { "features", required_argument, 0, 'F' },
+    { "project", required_argument, 0, 'J' },
     { "help", no_argument, 0, 'h' },
     { 0, 0, 0, 0 }
   };
 
   int optionIndex;
 
-  while (( c = getopt_long ( argc, argv, "rcdvht:", long_options, &optionIndex )) != -1 ) {
+  while (( c = getopt_long ( argc, argv, "rcdvht:g:C:P:D:m:M:w:b:k:R:X:S:W:T:L:F:J:", long_options, &optionIndex )) != -1 ) {
     switch ( c ) {
       case 0:
         if ( long_options[ optionIndex ].flag != 0 ) 
@@ -115,12 +268,71 @@ int main (int argc, char** argv) {
         break;
       case 't':
         if ( optarg ) {
-          time = std::stoi( optarg );
+          limits.timeout = std::stod( optarg );
         } else {
           std::cout << "Please specify a time\n";
           return -1;
         }
         break;
+      case 'C':
+        limits.maxConflicts = std::stoull( optarg );
+        break;
+      case 'P':
+        limits.maxPropagations = std::stoull( optarg );
+        break;
+      case 'D':
+        limits.maxDecisions = std::stoull( optarg );
+        break;
+      case 'm':
+        limits.maxMemoryMB = std::stol( optarg );
+        break;
+      case 'M':
+        memorySoftMB = std::stol( optarg );
+        break;
+      case 'w':
+        walkInterval = std::stoi( optarg );
+        walkGiven = true;
+        break;
+      case 'b':
+        chronoThreshold = std::stoi( optarg );
+        chronoGiven = true;
+        break;
+      case 'k':
+        checkpointFile = optarg;
+        break;
+      case 'R':
+        resumeFile = optarg;
+        break;
+      case 'X':
+        traceFile = optarg;
+        break;
+      case 'S':
+        servePath = optarg;
+        break;
+      case 'W':
+        workers = std::stoi( optarg );
+        break;
+      case 'T':
+        threads = std::stoi( optarg );
+        threadsGiven = true;
+        break;
+      case 'L':
+        presetsFile = optarg;
+        autoFlag = 1;
+        break;
+      case 'F':
+        featuresFile = optarg;
+        break;
+      case 'g':
+        genSpec = optarg;
+        break;
+      case 'J':
+        if ( !parseVarList( optarg, &projection ) ) {
+          std::cout << "Invalid projection " << optarg << "\n";
+          return -1;
+        }
+        allFlag = 1;
+        break;
       case '?':
         help();
         return -1;
@@ -129,6 +341,26 @@ int main (int argc, char** argv) {
     }
   }
 
+  if ( genSpec ) {
+    if ( generateFromSpec( genSpec, std::cout ) )
+      return 0;
+    generatorHelp();
+    return -1;
+  }
+
+  installInterruptHandler();
+
+  if ( servePath ) {
+    DaemonOptions options;
+    options.socketPath = servePath;
+    options.workers = workers;
+    options.limits = limits;
+    options.walkInterval = walkInterval;
+    options.chronoThreshold = chronoThreshold;
+    options.memorySoftMB = memorySoftMB;
+    return runDaemon( &options );
+  }
+
   if ( argc - optind > 0 ) {
     satFile = argv[optind];
   } else {
@@ -136,27 +368,120 @@ int main (int argc, char** argv) {
     return -1;
   }
   
-  if ( dpllFlag && !cdclFlag && !randFlag) {
-    DPLLSolver solver;
-    if ( simpleParse( &solver, satFile ) )
-      dpllEval( solver, time );
-    return 1;
-  } else if ( cdclFlag && !randFlag ) {
-    CDCLSolver solver;
-    if ( simpleParse( &solver, satFile ) )
-      cdclEval( solver, time, verbose );
+  std::vector<Preset> presets;
+  if ( presetsFile ) {
+    std::ifstream in( presetsFile );
+    std::string error;
+    if ( !in.is_open() || !parsePresets( in, &presets, &error ) ) {
+      std::cout << "Cannot load presets " << presetsFile << ( error.empty() ? "" : ": " ) << error << "\n";
+      return -1;
+    }
+  } else if ( autoFlag ) {
+    defaultPresets( &presets );
+  }
+
+  // every engine parses the same way, so parse once and choose afterwards
+  std::string engine = randFlag ? "random" : dpllFlag && !cdclFlag ? "dpll" : "cdcl";
+  bool engineGiven = randFlag || dpllFlag || cdclFlag;
+  CDCLSolver solver;
+  solver.stats = &stats;
+  PerfCounters counters;
+  if ( perfFlag && counters.open() )
+    solver.counters = &counters;
+  else if ( perfFlag )
+    std::cerr << "c hardware counters unavailable: " << counters.status << "\n";
+  // enumeration needs every model of the formula as given
+  solver.eliminatePure = !allFlag;
+  status = cdclFlag && !randFlag ? -1 : 1;
+  if ( allFlag && engineGiven && engine != "cdcl" ) {
+    std::cout << "Model enumeration needs the CDCL engine\n";
     return -1;
-  } else if ( randFlag ){
-    Solver solver;
-    if ( simpleParse( &solver, satFile ) )
-      randomEval ( solver, time );
-    return 1;
-  } else {
-    CDCLSolver solver;
-    if ( simpleParse( &solver, satFile ) )
-      cdclEval( solver, time, verbose );
-    return 1;
   }
+  if ( allFlag && ( !checkpointFile.empty() || !resumeFile.empty() ) ) {
+    std::cout << "Model enumeration cannot be combined with checkpoints\n";
+    return -1;
+  }
+  if ( simpleParse( &solver, satFile ) ) {
+    if ( autoFlag || featuresFile ) {
+      Features features;
+      extractFeatures( &solver, &features );
+      stats.preprocessTime += features.extractTime;
+      if ( featuresFile && !strcmp( featuresFile, "-" ) ) {
+        printFeaturesJson( &features, std::cerr );
+      } else if ( featuresFile ) {
+        std::ofstream out( featuresFile );
+        printFeaturesJson( &features, out );
+      }
+      const Preset* preset = selectPreset( &presets, &features );
+      if ( preset ) {
+        stats.preset = preset->name.c_str();
+        if ( !engineGiven && !allFlag && !preset->engine.empty() )
+          engine = preset->engine;
+        if ( !walkGiven && preset->walkInterval != PRESET_UNSET )
+          walkInterval = preset->walkInterval;
+        if ( !chronoGiven && preset->chronoThreshold != PRESET_UNSET )
+          chronoThreshold = preset->chronoThreshold;
+        if ( !threadsGiven && preset->threads != PRESET_UNSET )
+          threads = preset->threads;
+        if ( verbose )
+          std::cerr << "c preset " << preset->name << ", engine " << engine << "\n";
+      }
+    }
+    if ( engine == "dpll" ) {
+      if ( clausesOnly( &solver ) )
+        dpllEval( &solver, &limits, verbose );
+    } else if ( engine == "random" ) {
+      stats.engine = "random";
+      if ( clausesOnly( &solver ) ) {
+        timePoint start = now();
+        randomEval( &solver, &limits );
+        stats.solveTime = secondsSince( start );
+      }
+    } else {
+      solver.walkInterval = walkInterval;
+      solver.chronoThreshold = chronoThreshold;
+      solver.checkpointFile = checkpointFile;
+      solver.resumeFile = resumeFile;
+      solver.threads = threads;
+      solver.memorySoftLimit = (size_t) memorySoftMB << 20;
+      TraceWriter traceWriter;
+      std::unique_ptr<TraceBuffer> trace;
+      if ( traceFile && traceWriter.open( traceFile ) ) {
+        trace.reset( new TraceBuffer( &traceWriter ) );
+        solver.trace = trace.get();
+      } else if ( traceFile ) {
+        std::cerr << "c cannot write trace " << traceFile << "\n";
+      }
+      if ( allFlag ) {
+        bool valid = true;
+        std::vector<bool> listed( solver.numVars + 1, false );
+        for ( int i = 0; i < projection.size() && valid; i++ ) {
+          valid = projection[i].second <= solver.numVars;
+          for ( int v = projection[i].first; v <= projection[i].second && valid; v++ ) {
+            if ( !listed[v] )
+              solver.projection.push_back( v );
+            listed[v] = true;
+          }
+        }
+        if ( valid ) {
+          ModelWriter models( stdout );
+          int result = cdclEnumerate( &solver, &limits, verbose, &models );
+          std::cout << "models " << stats.models << ( result == RESULT_UNKNOWN ? " incomplete\n" : " complete\n" );
+        } else {
+          std::cout << "Projection variable exceeds the problem line\n";
+        }
+      } else {
+        cdclEval( &solver, &limits, verbose );
+      }
+    }
+  }
+  if ( perfFlag )
+    counters.report( &stats );
+  if ( statsFlag ) {
+    std::cout << std::flush;
+    printStatsJson( &stats, std::cerr );
+  }
+  return status;
 }
 
 
@@ -9,26 +9,30 @@
 using namespace std;
 
 // constructor
-Clause::Clause(std::vector<unsigned int>* v, std::vector<bool>* isNot, int numv, int i) {
+Clause::Clause(std::vector<unsigned int>* v, std::vector<bool>* isNot, int numv, int i)
+  : Clause( *v, *isNot, numv, i )
+{}
+
+Clause::Clause(std::vector<unsigned int> v, std::vector<bool> isNot, int numv, int i)
+  : vars( std::move( v ) ), polarity( std::move( isNot ) ) {
   numVars = numv;
-  vars = *v;
-  polarity = *isNot;
   index = i;
   if ( numVars > 1 ) {
     watchedLits.fst = ( polarity[0] ? -1 : 1 ) * vars[0];
     watchedLits.snd = ( polarity[1] ? -1 : 1 ) * vars[1];
   }
-  else {
+  else if ( numVars == 1 ) {
     watchedLits.fst = ( polarity[0] ? -1 : 1 ) * vars[0];
     watchedLits.snd = 0;
   }
+  else {
+    // the empty clause
+    watchedLits.fst = 0;
+    watchedLits.snd = 0;
+  }
   conflictIndex = -1;
 }
 
-Clause::Clause(std::vector<unsigned int> v, std::vector<bool> isNot, int numv, int i) 
-  : Clause(&v, &isNot, numv, i)
-{}
-
 // conflict constructor
 Clause::Clause( int cause  ) {
   numVars = -1;
@@ -48,36 +52,15 @@ bool Clause::hasLit( int lit ) {
   return false;
 }
 
-bool Solver::moveWatchedLit( int index, int clause ) {
-  Clause c = formula[clause];
-  if ( ( index != 2 ) && ( index != 1 ) )
-    return false; // invalid input
-  if ( ( c.watchedLits.fst == 0 ) || ( c.watchedLits.snd == 0 ) )
-    return false;
-  int otherLit = index == 1 ? c.watchedLits.snd : c.watchedLits.fst;
-  int current = index == 1 ? c.watchedLits.fst : c.watchedLits.snd;
-  for ( int i = 0; i < c.numVars; i++ ) {
-    int var = c.vars[i];
-    int adjVar = var * ( c.polarity[i] ? -1 : 1 ); // holds sign information
-    if ( ( adjVar == current ) || ( adjVar == otherLit ) )
-      continue;
-    if ( ( ( ( sigma[var] == 1 ) ^ c.polarity[i] ) && ( sigma[var] != 0 ) ) || ( sigma[var] == 0 ) ) {
-      index == 1 ? c.watchedLits.fst = adjVar : c.watchedLits.snd = adjVar;
-      formula[clause] = c;
-      return true;
-    }
-  }
-  formula[clause] = c;
-  return false; 
-}
-
 // constructor
-Solver::Solver(std::vector<Clause> f, std::vector<int> s, int numc, int numv) {
-  formula = f;
-  sigma = s;
+Solver::Solver(std::vector<Clause> f, std::vector<int> s, int numc, int numv)
+  : formula( std::move( f ) ), sigma( std::move( s ) ) {
   numClauses = numc;
   numVars = numv;
   numAssigned = 0; // TODO: make this correct
+  stats = nullptr;
+  eliminatePure = true;
+  counters = nullptr;
 }
 
 // constructor
@@ -88,6 +71,9 @@ Solver::Solver() {
   numClauses = 0;
   numVars = 0;
   numAssigned = 0;
+  stats = nullptr;
+  eliminatePure = true;
+  counters = nullptr;
 }
 
 // clear current evaluation
@@ -110,14 +96,13 @@ long long int generateRandomAssignment( int numVars, std::vector<int>* sigma ) {
 }
 
 // evaluate a given clause
-bool evaluateClause ( Clause clause, std::vector<int> sigma ) {
+bool evaluateClause ( const Clause& clause, const std::vector<int>& sigma ) {
   int numv = clause.numVars;
   for ( int i = 0; i < numv; i++ ) { 
     unsigned int var = clause.vars[i];
     bool isNegative = clause.polarity[i];
-    bool val = sigma[var]; 
-    //std::cout << "Evaluating var: " << var << " is negative: " << isNegative << " val: " << val << "\n";
-    if ( isNegative ^ ( val != -1 ) ) {
+    int val = sigma[var];
+    if ( isNegative ^ ( val == 1 ) ) {
       return true;
     }
   }
@@ -126,8 +111,8 @@ bool evaluateClause ( Clause clause, std::vector<int> sigma ) {
 
 // evaluate formula clause-by-clause
 bool evaluate ( Solver* solver ) {
-  std::vector<Clause> formula = solver->formula;
-  std::vector<int> sigma = solver->sigma;
+  const std::vector<Clause>& formula = solver->formula;
+  const std::vector<int>& sigma = solver->sigma;
   int numc = solver->numClauses;
   //std::cout << "evaluating " << numc << " clauses\n";
   for ( int i = 0; i < numc; i++ ) {
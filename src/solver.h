@@ -3,6 +3,14 @@
 
 #include <vector>
 #include <stack>
+#include "stats.h"
+
+struct PerfCounters;
+
+// outcome of a search
+#define RESULT_SAT 1
+#define RESULT_UNSAT 0
+#define RESULT_UNKNOWN -1
 
 template<typename T>
 struct pair {
@@ -17,8 +25,10 @@ class Clause {
     int conflictIndex;
     std::vector<unsigned int> vars;
     std::vector<bool> polarity; //true indicates variable is negative in SAT formula
+    // copies the literals; the other form takes them over, so pass
+    // temporaries or std::move to build a clause without copying
     Clause ( std::vector<unsigned int>* v, std::vector<bool>* isNot, int numv, int i );
-    Clause( std::vector<unsigned int> v, std::vector<bool> isNot, int numv, int i ); 
+    Clause ( std::vector<unsigned int> v, std::vector<bool> isNot, int numv, int i );
     Clause ( int index );
     Clause ();
     bool hasLit ( int lit );
@@ -26,6 +36,21 @@ class Clause {
     int index;
 };
 
+// XOR constraint: the variables sum to rhs modulo 2
+struct Xor {
+  std::vector<unsigned int> vars;
+  bool rhs;
+  bool encoded; // its clauses are in the formula too, recovered from them
+};
+
+// Cardinality constraint: at most bound of the literals are true
+struct Card {
+  std::vector<unsigned int> vars;
+  std::vector<bool> polarity; // true for a negated literal
+  int bound;
+  bool encoded; // its clauses are in the formula too, recovered from them
+};
+
 // Data structure storing information on a conflict
 struct conflict {
   Clause* clause;
@@ -37,15 +62,19 @@ struct conflict {
 class Solver {
   public:
     std::vector<Clause> formula;
+    std::vector<Xor> xors; // only used by CDCL
+    std::vector<Card> cards; // only used by CDCL
     std::vector<int> sigma;
     std::vector<int> sigmaStack;
     int numClauses;
     int numVars;
     int numAssigned;
-    Solver ( std::vector<Clause> f, std::vector<int> s, int numc, int numv );
+    SolverStats* stats; // shared by copies of this solver, may be null
+    bool eliminatePure; // the parser assigns pure literals and drops their clauses
+    PerfCounters* counters; // hardware counters of this thread by phase, null for none
+    Solver ( std::vector<Clause> f, std::vector<int> s, int numc, int numv ); // moves f and s in
     Solver ();
     void clear ();
-    bool moveWatchedLit ( int index, int clause );
 };
 
 
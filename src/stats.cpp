@@ -0,0 +1,234 @@
+#include "stats.h"
+#include <ostream>
+#include <iomanip>
+
+SolverStats::SolverStats() {
+  reset();
+}
+
+void SolverStats::reset() {
+  decisions = 0;
+  propagations = 0;
+  conflicts = 0;
+  learnedClauses = 0;
+  learnedLiterals = 0;
+  restarts = 0;
+  deletedClauses = 0;
+  garbageCollections = 0;
+  failedLiterals = 0;
+  walks = 0;
+  walkFlips = 0;
+  rephases = 0;
+  checkpoints = 0;
+  backjumps = 0;
+  backjumpDistance = 0;
+  maxBackjumpDistance = 0;
+  chronoBacktracks = 0;
+  components = 1;
+  xorConstraints = 0;
+  gaussPropagations = 0;
+  gaussConflicts = 0;
+  cardConstraints = 0;
+  cardPropagations = 0;
+  cardConflicts = 0;
+  models = 0;
+  blockingLiterals = 0;
+  for ( int k = 0; k < MEMORY_KINDS; k++ ) {
+    memory[k] = 0;
+    peakMemory[k] = 0;
+  }
+  peakMemoryTotal = 0;
+  memoryReductions = 0;
+  for ( int p = 0; p < PHASE_KINDS; p++ ) {
+    for ( int k = 0; k < PERF_COUNTERS; k++ )
+      phaseCounters[p][k] = 0;
+  }
+  countersAvailable = 0;
+  countersEnabled = 0;
+  countersRunning = 0;
+  countersStatus = "off";
+  parseTime = 0;
+  preprocessTime = 0;
+  propagateTime = 0;
+  analyzeTime = 0;
+  solveTime = 0;
+  engine = "none";
+  result = "unknown";
+  stopReason = "none";
+  preset = "none";
+}
+
+void SolverStats::add ( const SolverStats* other ) {
+  decisions += other->decisions;
+  propagations += other->propagations;
+  conflicts += other->conflicts;
+  learnedClauses += other->learnedClauses;
+  learnedLiterals += other->learnedLiterals;
+  restarts += other->restarts;
+  deletedClauses += other->deletedClauses;
+  garbageCollections += other->garbageCollections;
+  failedLiterals += other->failedLiterals;
+  walks += other->walks;
+  walkFlips += other->walkFlips;
+  rephases += other->rephases;
+  checkpoints += other->checkpoints;
+  backjumps += other->backjumps;
+  backjumpDistance += other->backjumpDistance;
+  if ( other->maxBackjumpDistance > maxBackjumpDistance )
+    maxBackjumpDistance = other->maxBackjumpDistance;
+  chronoBacktracks += other->chronoBacktracks;
+  gaussPropagations += other->gaussPropagations;
+  gaussConflicts += other->gaussConflicts;
+  cardPropagations += other->cardPropagations;
+  cardConflicts += other->cardConflicts;
+  models += other->models;
+  blockingLiterals += other->blockingLiterals;
+  // components run side by side, so their peaks are summed as a bound
+  for ( int k = 0; k < MEMORY_KINDS; k++ ) {
+    memory[k] += other->memory[k];
+    peakMemory[k] += other->peakMemory[k];
+  }
+  peakMemoryTotal += other->peakMemoryTotal;
+  memoryReductions += other->memoryReductions;
+  for ( int p = 0; p < PHASE_KINDS; p++ ) {
+    for ( int k = 0; k < PERF_COUNTERS; k++ )
+      phaseCounters[p][k] += other->phaseCounters[p][k];
+  }
+  countersAvailable |= other->countersAvailable;
+  countersEnabled += other->countersEnabled;
+  countersRunning += other->countersRunning;
+  parseTime += other->parseTime;
+  preprocessTime += other->preprocessTime;
+  propagateTime += other->propagateTime;
+  analyzeTime += other->analyzeTime;
+}
+
+void SolverStats::recordMemory ( const size_t* bytes ) {
+  size_t total = 0;
+  for ( int k = 0; k < MEMORY_KINDS; k++ ) {
+    memory[k] = bytes[k];
+    if ( bytes[k] > peakMemory[k] )
+      peakMemory[k] = bytes[k];
+    total += bytes[k];
+  }
+  if ( total > peakMemoryTotal )
+    peakMemoryTotal = total;
+}
+
+const char* memoryNames[ MEMORY_KINDS ] = { "original", "learned", "watches", "trail", "heuristics" };
+
+const char* phaseNames[ PHASE_KINDS ] = { "parse", "preprocess", "propagate", "analyze", "backjump" };
+const char* counterNames[ PERF_COUNTERS ] = { "cycles", "instructions", "cache_misses", "branch_misses", "l1d_misses" };
+
+// a / b as a JSON number, null if a counter is missing or b is 0
+static void printRatio ( std::ostream& out, bool known, double a, double b ) {
+  if ( known && b > 0 )
+    out << a / b;
+  else
+    out << "null";
+}
+
+static void printCountersJson ( SolverStats* stats, std::ostream& out ) {
+  out << "{\"status\": \"" << stats->countersStatus << "\"";
+  if ( !stats->countersAvailable ) {
+    out << "}";
+    return;
+  }
+  int has = stats->countersAvailable;
+  bool instructions = has & ( 1 << PERF_INSTRUCTIONS );
+  out << ", \"scheduled\": " << ( stats->countersEnabled ? (double) stats->countersRunning / stats->countersEnabled : 0 );
+  for ( int p = 0; p < PHASE_KINDS; p++ ) {
+    const unsigned long long* c = stats->phaseCounters[p];
+    out << ", \"" << phaseNames[p] << "\": {";
+    for ( int k = 0; k < PERF_COUNTERS; k++ ) {
+      out << ( k ? ", " : "" ) << "\"" << counterNames[k] << "\": ";
+      if ( has & ( 1 << k ) )
+        out << c[k];
+      else
+        out << "null";
+    }
+    // instructions per cycle and misses per thousand instructions
+    double kilo = c[ PERF_INSTRUCTIONS ] / 1000.0;
+    out << ", \"ipc\": ";
+    printRatio( out, instructions && ( has & ( 1 << PERF_CYCLES ) ), c[ PERF_INSTRUCTIONS ], c[ PERF_CYCLES ] );
+    out << ", \"cache_mpki\": ";
+    printRatio( out, instructions && ( has & ( 1 << PERF_CACHE_MISSES ) ), c[ PERF_CACHE_MISSES ], kilo );
+    out << ", \"branch_mpki\": ";
+    printRatio( out, instructions && ( has & ( 1 << PERF_BRANCH_MISSES ) ), c[ PERF_BRANCH_MISSES ], kilo );
+    out << ", \"l1d_mpki\": ";
+    printRatio( out, instructions && ( has & ( 1 << PERF_L1D_MISSES ) ), c[ PERF_L1D_MISSES ], kilo );
+    out << "}";
+  }
+  const unsigned long long* propagate = stats->phaseCounters[ PHASE_PROPAGATE ];
+  out << ", \"instructions_per_propagation\": ";
+  printRatio( out, instructions, propagate[ PERF_INSTRUCTIONS ], stats->propagations );
+  out << ", \"cache_misses_per_propagation\": ";
+  printRatio( out, has & ( 1 << PERF_CACHE_MISSES ), propagate[ PERF_CACHE_MISSES ], stats->propagations );
+  out << ", \"instructions_per_conflict\": ";
+  printRatio( out, instructions, stats->phaseCounters[ PHASE_ANALYZE ][ PERF_INSTRUCTIONS ], stats->learnedClauses );
+  out << "}";
+}
+
+void printStatsLine ( SolverStats* stats, std::ostream& out ) {
+  out << "c " << std::fixed << std::setprecision( 2 ) << stats->solveTime << "s"
+      << " decisions: " << stats->decisions
+      << " propagations: " << stats->propagations
+      << " conflicts: " << stats->conflicts
+      << " learned: " << stats->learnedClauses
+      << " restarts: " << stats->restarts << "\n";
+}
+
+void printStatsJson ( SolverStats* stats, std::ostream& out ) {
+  double avgJump = stats->backjumps ? (double) stats->backjumpDistance / stats->backjumps : 0;
+  double avgLearned = stats->learnedClauses ? (double) stats->learnedLiterals / stats->learnedClauses : 0;
+  out << std::fixed << std::setprecision( 6 );
+  out << "{\"engine\": \"" << stats->engine << "\""
+      << ", \"result\": \"" << stats->result << "\""
+      << ", \"stop_reason\": \"" << stats->stopReason << "\""
+      << ", \"preset\": \"" << stats->preset << "\""
+      << ", \"decisions\": " << stats->decisions
+      << ", \"propagations\": " << stats->propagations
+      << ", \"conflicts\": " << stats->conflicts
+      << ", \"learned_clauses\": " << stats->learnedClauses
+      << ", \"learned_literals\": " << stats->learnedLiterals
+      << ", \"avg_learned_size\": " << avgLearned
+      << ", \"restarts\": " << stats->restarts
+      << ", \"deleted_clauses\": " << stats->deletedClauses
+      << ", \"garbage_collections\": " << stats->garbageCollections
+      << ", \"failed_literals\": " << stats->failedLiterals
+      << ", \"local_search_runs\": " << stats->walks
+      << ", \"local_search_flips\": " << stats->walkFlips
+      << ", \"rephases\": " << stats->rephases
+      << ", \"checkpoints\": " << stats->checkpoints
+      << ", \"backjumps\": " << stats->backjumps
+      << ", \"avg_backjump_distance\": " << avgJump
+      << ", \"max_backjump_distance\": " << stats->maxBackjumpDistance
+      << ", \"chrono_backtracks\": " << stats->chronoBacktracks
+      << ", \"components\": " << stats->components
+      << ", \"xor_constraints\": " << stats->xorConstraints
+      << ", \"gauss_propagations\": " << stats->gaussPropagations
+      << ", \"gauss_conflicts\": " << stats->gaussConflicts
+      << ", \"card_constraints\": " << stats->cardConstraints
+      << ", \"card_propagations\": " << stats->cardPropagations
+      << ", \"card_conflicts\": " << stats->cardConflicts
+      << ", \"models\": " << stats->models
+      << ", \"blocking_literals\": " << stats->blockingLiterals
+      << ", \"memory_reductions\": " << stats->memoryReductions
+      << ", \"memory\": {";
+  size_t total = 0;
+  for ( int k = 0; k < MEMORY_KINDS; k++ ) {
+    out << "\"" << memoryNames[k] << "\": {\"current\": " << stats->memory[k]
+        << ", \"peak\": " << stats->peakMemory[k] << "}, ";
+    total += stats->memory[k];
+  }
+  out << "\"total\": {\"current\": " << total << ", \"peak\": " << stats->peakMemoryTotal << "}}"
+      << ", \"counters\": ";
+  printCountersJson( stats, out );
+  out << ", \"time\": {"
+      << "\"parse\": " << stats->parseTime
+      << ", \"preprocess\": " << stats->preprocessTime
+      << ", \"propagate\": " << stats->propagateTime
+      << ", \"analyze\": " << stats->analyzeTime
+      << ", \"solve\": " << stats->solveTime
+      << "}}\n";
+}
@@ -0,0 +1,103 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <ostream>
+#include <stddef.h>
+
+typedef std::chrono::steady_clock::time_point timePoint;
+
+// subsystems of the memory accounting
+#define MEMORY_ORIGINAL 0 // parsed formula, original clauses and constraints
+#define MEMORY_LEARNED 1 // learned and derived clauses
+#define MEMORY_WATCHES 2
+#define MEMORY_TRAIL 3 // assignment, trail, levels and reasons
+#define MEMORY_HEURISTICS 4 // activities, heap, phases and scratch space
+#define MEMORY_KINDS 5
+
+// hardware counters read around each phase with --perf
+#define PERF_CYCLES 0
+#define PERF_INSTRUCTIONS 1
+#define PERF_CACHE_MISSES 2 // last level cache
+#define PERF_BRANCH_MISSES 3
+#define PERF_L1D_MISSES 4 // L1 data cache read misses
+#define PERF_COUNTERS 5
+
+// phases the hardware counters are attributed to
+#define PHASE_PARSE 0
+#define PHASE_PREPROCESS 1
+#define PHASE_PROPAGATE 2 // unit propagation with XOR and cardinality rules
+#define PHASE_ANALYZE 3 // conflict analysis and clause minimization
+#define PHASE_BACKJUMP 4 // undoing the trail to the backjump level
+#define PHASE_KINDS 5
+
+// Counters and phase timers collected while solving. Counters are plain
+// increments and timers are read once per phase, so they are always enabled.
+struct SolverStats {
+  unsigned long long decisions;
+  unsigned long long propagations;
+  unsigned long long conflicts;
+  unsigned long long learnedClauses;
+  unsigned long long learnedLiterals;
+  unsigned long long restarts;
+  unsigned long long deletedClauses; // learned clauses removed by reductions
+  unsigned long long garbageCollections;
+  unsigned long long failedLiterals; // found by lookahead
+  unsigned long long walks; // local search runs
+  unsigned long long walkFlips;
+  unsigned long long rephases; // walks whose result became the saved phases
+  unsigned long long checkpoints; // checkpoint files written
+  unsigned long long backjumps;
+  unsigned long long backjumpDistance; // sum of levels undone by backjumps
+  int maxBackjumpDistance;
+  unsigned long long chronoBacktracks; // backjumps cut short to one level
+  int components; // independent parts solved separately, 1 if not split
+  int xorConstraints; // rows of the XOR matrix, given or recovered
+  unsigned long long gaussPropagations; // literals implied by elimination
+  unsigned long long gaussConflicts;
+  int cardConstraints; // at-most-k constraints, given or recovered
+  unsigned long long cardPropagations;
+  unsigned long long cardConflicts;
+  unsigned long long models; // found by enumeration
+  unsigned long long blockingLiterals; // summed over the blocking clauses
+  size_t memory[ MEMORY_KINDS ]; // bytes at the last sample
+  size_t peakMemory[ MEMORY_KINDS ];
+  size_t peakMemoryTotal; // largest sum of one sample
+  unsigned long long memoryReductions; // forced by the soft memory limit
+  // hardware counter totals by PHASE_* and PERF_*, 0 unless --perf
+  unsigned long long phaseCounters[ PHASE_KINDS ][ PERF_COUNTERS ];
+  int countersAvailable; // bit 1 << PERF_* for each counter that was read
+  // ns the counter groups were enabled and on the PMU, summed over threads
+  unsigned long long countersEnabled;
+  unsigned long long countersRunning;
+  const char* countersStatus; // "off", "on", or why none could be opened
+  double parseTime;
+  double preprocessTime;
+  double propagateTime;
+  double analyzeTime;
+  double solveTime;
+  const char* engine;
+  const char* result;
+  const char* stopReason; // budget that ended an unknown search
+  const char* preset; // configuration chosen by --auto
+  SolverStats ();
+  void reset ();
+  void add ( const SolverStats* other ); // sum the counters and timers
+  void recordMemory ( const size_t* bytes ); // a sample of every subsystem
+};
+
+inline timePoint now () {
+  return std::chrono::steady_clock::now();
+}
+
+inline double secondsSince ( timePoint start ) {
+  return std::chrono::duration<double>( now() - start ).count();
+}
+
+// one-line progress report, used periodically in verbose mode
+void printStatsLine ( SolverStats* stats, std::ostream& out );
+
+// full report as a single JSON object
+void printStatsJson ( SolverStats* stats, std::ostream& out );
+
+#endif
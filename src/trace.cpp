@@ -0,0 +1,56 @@
+#include "trace.h"
+#include <chrono>
+
+TraceWriter::TraceWriter () {
+  file = NULL;
+  nextThread = 0;
+  start = now();
+}
+
+TraceWriter::~TraceWriter () {
+  if ( file )
+    fclose( file );
+}
+
+bool TraceWriter::open ( const std::string& path ) {
+  file = fopen( path.c_str(), "wb" );
+  if ( !file )
+    return false;
+  TraceHeader header = { TRACE_MAGIC, TRACE_VERSION, sizeof( TraceEvent ) };
+  fwrite( &header, sizeof( header ), 1, file );
+  start = now();
+  return true;
+}
+
+void TraceWriter::write ( uint32_t thread, const TraceEvent* events, uint32_t count ) {
+  std::lock_guard<std::mutex> guard( lock );
+  TraceChunk chunk = { thread, count };
+  fwrite( &chunk, sizeof( chunk ), 1, file );
+  fwrite( events, sizeof( TraceEvent ), count, file );
+}
+
+TraceBuffer::TraceBuffer ( TraceWriter* w ) : writer( w ), events( TRACE_BUFFER_EVENTS ), used( 0 ) {
+  std::lock_guard<std::mutex> guard( w->lock );
+  thread = w->nextThread++;
+}
+
+TraceBuffer::~TraceBuffer () {
+  flush();
+}
+
+void TraceBuffer::flush () {
+  if ( used )
+    writer->write( thread, &events[0], used );
+  used = 0;
+}
+
+void TraceBuffer::record ( uint32_t type, int a, int b, int c ) {
+  if ( used == events.size() )
+    flush();
+  TraceEvent& e = events[ used++ ];
+  e.time = std::chrono::duration_cast<std::chrono::nanoseconds>( now() - writer->start ).count();
+  e.type = type;
+  e.arg[0] = a;
+  e.arg[1] = b;
+  e.arg[2] = c;
+}
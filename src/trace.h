@@ -0,0 +1,80 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <stdio.h>
+#include <stdint.h>
+#include "stats.h"
+
+// Binary trace of CDCL search events for offline profiling, read by
+// tools/tracetool. The file starts with a TraceHeader; every flush then
+// appends a TraceChunk followed by count TraceEvents of one buffer. All
+// fields are little-endian as written by the solver's host.
+#define TRACE_MAGIC 0x45434152544153ULL // "SATRACE"
+#define TRACE_VERSION 1
+
+// events per buffer; a full buffer is flushed to the file
+#define TRACE_BUFFER_EVENTS 16384
+
+// event types and their arguments
+#define TRACE_DECISION 1 // literal (DIMACS), new level
+#define TRACE_PROPAGATE 2 // literals assigned, level, nanoseconds taken before
+#define TRACE_CONFLICT 3 // learned clause size, LBD, backjump level
+#define TRACE_RESTART 4 // restarts so far, conflicts so far
+#define TRACE_REDUCE 5 // learned clauses kept, removed
+#define TRACE_RESULT 6 // RESULT_* of the search, conflicts so far
+
+struct TraceHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t eventSize; // sizeof( TraceEvent )
+};
+
+struct TraceChunk {
+  uint32_t thread; // id of the buffer that wrote the chunk
+  uint32_t count;
+};
+
+struct TraceEvent {
+  uint64_t time; // nanoseconds from opening the trace to recording the event
+  uint32_t type;
+  int32_t arg[3];
+};
+
+// The trace file, shared by the buffers of all threads. Only flushes take
+// its lock.
+struct TraceWriter {
+  FILE* file;
+  timePoint start;
+  std::mutex lock;
+  uint32_t nextThread;
+  TraceWriter ();
+  ~TraceWriter ();
+  bool open ( const std::string& path );
+  void write ( uint32_t thread, const TraceEvent* events, uint32_t count );
+};
+
+// Events of one search thread. Recording writes to the buffer owned by the
+// thread without synchronization; the buffer is flushed when full and when
+// it is destroyed.
+struct TraceBuffer {
+  TraceWriter* writer;
+  uint32_t thread;
+  std::vector<TraceEvent> events;
+  size_t used;
+  TraceBuffer ( TraceWriter* w );
+  ~TraceBuffer ();
+  void flush ();
+  void record ( uint32_t type, int a, int b, int c );
+};
+
+// A search without a trace has a null buffer, so a disabled event costs a
+// test and a branch
+inline void traceEvent ( TraceBuffer* trace, uint32_t type, int a, int b, int c ) {
+  if ( trace )
+    trace->record( type, a, b, c );
+}
+
+#endif
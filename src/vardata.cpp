@@ -0,0 +1,87 @@
+#include "vardata.h"
+#include "literal.h"
+#include <vector>
+
+VarData::VarData() {
+  activityInc = 1;
+}
+
+// variables 1..numVars, all unassigned and queued with phase false
+void VarData::init ( int numVars ) {
+  level.assign( numVars + 1, 0 );
+  reason.assign( numVars + 1, CLAUSE_NONE );
+  position.assign( numVars + 1, 0 );
+  phase.assign( numVars + 1, VALUE_FALSE );
+  heapIndex.assign( numVars + 1, -1 );
+  activity.assign( numVars + 1, 0 );
+  heap.clear();
+  activityInc = 1;
+  for ( int v = 1; v < numVars + 1; v++ )
+    insert( v );
+}
+
+void VarData::percolateUp ( int i ) {
+  int v = heap[i];
+  while ( i > 0 ) {
+    int parent = ( i - 1 ) / 2;
+    if ( activity[ heap[parent] ] >= activity[v] )
+      break;
+    heap[i] = heap[parent];
+    heapIndex[ heap[i] ] = i;
+    i = parent;
+  }
+  heap[i] = v;
+  heapIndex[v] = i;
+}
+
+void VarData::percolateDown ( int i ) {
+  int v = heap[i];
+  int n = heap.size();
+  while ( 2 * i + 1 < n ) {
+    int child = 2 * i + 1;
+    if ( child + 1 < n && activity[ heap[child + 1] ] > activity[ heap[child] ] )
+      child++;
+    if ( activity[ heap[child] ] <= activity[v] )
+      break;
+    heap[i] = heap[child];
+    heapIndex[ heap[i] ] = i;
+    i = child;
+  }
+  heap[i] = v;
+  heapIndex[v] = i;
+}
+
+void VarData::insert ( int v ) {
+  if ( inHeap( v ) )
+    return;
+  heap.push_back( v );
+  percolateUp( heap.size() - 1 );
+}
+
+int VarData::removeMax () {
+  int v = heap[0];
+  heapIndex[v] = -1;
+  int last = heap.back();
+  heap.pop_back();
+  if ( !heap.empty() ) {
+    heap[0] = last;
+    heapIndex[last] = 0;
+    percolateDown( 0 );
+  }
+  return v;
+}
+
+void VarData::bump ( int v ) {
+  activity[v] += activityInc;
+  if ( activity[v] > ACTIVITY_LIMIT ) {
+    for ( int u = 1; u < activity.size(); u++ )
+      activity[u] *= 1 / ACTIVITY_LIMIT;
+    activityInc *= 1 / ACTIVITY_LIMIT;
+  }
+  if ( inHeap( v ) )
+    percolateUp( heapIndex[v] );
+}
+
+void VarData::decay () {
+  activityInc /= ACTIVITY_DECAY;
+}
@@ -0,0 +1,35 @@
+#ifndef VARDATA_H
+#define VARDATA_H
+
+#include <vector>
+#include <stdint.h>
+#include "clausedb.h"
+
+// VSIDS bump decay and the activity at which all activities are rescaled
+#define ACTIVITY_DECAY 0.95
+#define ACTIVITY_LIMIT 1e100
+
+// Per-variable search state kept as one array per field, so propagation only
+// pulls level and reason into cache and the decision heuristic only touches
+// its own arrays.
+struct VarData {
+  std::vector<int> level; // decision level of the assignment
+  std::vector<ClauseRef> reason; // implying clause, CLAUSE_NONE for decisions
+  std::vector<int> position; // index on the trail
+  std::vector<int8_t> phase; // saved polarity, VALUE_TRUE or VALUE_FALSE
+  std::vector<int> heapIndex; // position in heap, -1 when not queued
+  std::vector<double> activity;
+  std::vector<int> heap; // unassigned candidates, max-heap on activity
+  double activityInc;
+  VarData ();
+  void init ( int numVars );
+  bool inHeap ( int v ) const { return heapIndex[v] >= 0; }
+  void insert ( int v );
+  int removeMax ();
+  void bump ( int v );
+  void decay ();
+  void percolateUp ( int i );
+  void percolateDown ( int i );
+};
+
+#endif
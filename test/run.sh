@@ -0,0 +1,49 @@
+#!/bin/sh
+# Run the cases in cases.txt against the solver and print one line per
+# case. Exits non-zero if any output lacks its expected line.
+# usage: test/run.sh [solver]
+
+SOLVER=${1:-./satSolver}
+case "$SOLVER" in
+  /*) ;;
+  *) SOLVER=$(pwd)/$SOLVER ;;
+esac
+DIR=$(dirname "$0")
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+# kill runs that hang
+if command -v timeout >/dev/null 2>&1; then
+  GUARD="timeout 60"
+else
+  GUARD=""
+fi
+
+failed=0
+while IFS='|' read -r input options expected; do
+  input=$(echo "$input" | sed 's/^ *//; s/ *$//')
+  expected=$(echo "$expected" | sed 's/^ *//; s/ *$//')
+  case "$input" in
+    ''|'#'*) continue ;;
+  esac
+  eval "set -- $options"
+  output=$(cd "$DIR" && $GUARD "$SOLVER" "$@" < "$input" 2>&1)
+  case "$expected" in
+    '!'*)
+      echo "$output" | awk -v e="${expected#!}" 'index( $0, e ) { found = 1 } END { exit found }' ;;
+    *)
+      echo "$output" | awk -v e="$expected" '$0 == e || index( $0, e " " ) == 1 { found = 1 } END { exit !found }' ;;
+  esac
+  if [ $? -eq 0 ]; then
+    echo "ok    $input $*: $expected"
+  else
+    echo "FAIL  $input $*: $expected"
+    echo "$output" | head -n 5 | sed 's/^/      /'
+    failed=$((failed + 1))
+  fi
+done < "$DIR/cases.txt"
+
+if [ "$failed" -gt 0 ]; then
+  echo "$failed case(s) failed" >&2
+  exit 1
+fi
@@ -0,0 +1,67 @@
+// Counts the C++ heap allocations of a program it is preloaded into:
+//   LD_PRELOAD=tools/alloccount.so ./satSolver ...
+// At exit it writes "allocations N bytes B peak P" (P the most bytes held at
+// once) to stderr, or appends it to the file named by ALLOCCOUNT_OUT.
+#include <new>
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+#include <malloc.h>
+
+static std::atomic<unsigned long long> allocations( 0 );
+static std::atomic<unsigned long long> allocatedBytes( 0 );
+static std::atomic<long long> heldBytes( 0 );
+static std::atomic<long long> peakBytes( 0 );
+
+static void* counted ( size_t size ) {
+  void* p = malloc( size ? size : 1 );
+  if ( !p )
+    throw std::bad_alloc();
+  long long usable = malloc_usable_size( p );
+  allocations++;
+  allocatedBytes += usable;
+  long long held = heldBytes += usable;
+  long long peak = peakBytes.load();
+  while ( held > peak && !peakBytes.compare_exchange_weak( peak, held ) ) {
+  }
+  return p;
+}
+
+static void released ( void* p ) {
+  if ( !p )
+    return;
+  heldBytes -= malloc_usable_size( p );
+  free( p );
+}
+
+void* operator new ( size_t size ) { return counted( size ); }
+void* operator new[] ( size_t size ) { return counted( size ); }
+void* operator new ( size_t size, const std::nothrow_t& ) noexcept {
+  try {
+    return counted( size );
+  } catch ( ... ) {
+    return NULL;
+  }
+}
+void* operator new[] ( size_t size, const std::nothrow_t& ) noexcept {
+  try {
+    return counted( size );
+  } catch ( ... ) {
+    return NULL;
+  }
+}
+void operator delete ( void* p ) noexcept { released( p ); }
+void operator delete[] ( void* p ) noexcept { released( p ); }
+void operator delete ( void* p, size_t ) noexcept { released( p ); }
+void operator delete[] ( void* p, size_t ) noexcept { released( p ); }
+
+__attribute__(( destructor )) static void report () {
+  const char* path = getenv( "ALLOCCOUNT_OUT" );
+  FILE* out = path ? fopen( path, "a" ) : stderr;
+  if ( !out )
+    return;
+  fprintf( out, "allocations %llu bytes %llu peak %lld\n", allocations.load(),
+      allocatedBytes.load(), peakBytes.load() );
+  if ( path )
+    fclose( out );
+}
@@ -0,0 +1,185 @@
+// Reads the binary traces written by satSolver --trace.
+//   tracetool summary FILE   per thread counts, rates and a conflict timeline
+//   tracetool chrome FILE    Chrome trace JSON on stdout, for chrome://tracing
+//                            or Perfetto
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "trace.h"
+#include "solver.h"
+
+// slices of the conflict timeline
+#define TIMELINE_SLICES 10
+
+struct ThreadEvents {
+  std::vector<TraceEvent> events;
+};
+
+// Read every chunk of a trace into per-thread event lists in time order
+bool readTrace ( const char* path, std::map<uint32_t, ThreadEvents>* threads ) {
+  FILE* f = fopen( path, "rb" );
+  if ( !f ) {
+    std::cerr << "cannot open " << path << "\n";
+    return false;
+  }
+  TraceHeader header;
+  if ( fread( &header, sizeof( header ), 1, f ) != 1 || header.magic != TRACE_MAGIC
+      || header.version != TRACE_VERSION || header.eventSize != sizeof( TraceEvent ) ) {
+    std::cerr << path << " is not a version " << TRACE_VERSION << " trace\n";
+    fclose( f );
+    return false;
+  }
+  TraceChunk chunk;
+  while ( fread( &chunk, sizeof( chunk ), 1, f ) == 1 ) {
+    std::vector<TraceEvent>& events = ( *threads )[ chunk.thread ].events;
+    size_t first = events.size();
+    events.resize( first + chunk.count );
+    if ( fread( &events[ first ], sizeof( TraceEvent ), chunk.count, f ) != chunk.count ) {
+      std::cerr << path << " is truncated, reading what is complete\n";
+      events.resize( first );
+      break;
+    }
+  }
+  fclose( f );
+  return true;
+}
+
+// LBD histogram buckets: 1, 2, 3-4, 5-8, 9-16, more
+int lbdBucket ( int lbd ) {
+  int b = 0;
+  while ( b < 5 && lbd > ( 1 << b ) )
+    b++;
+  return b;
+}
+
+void summarize ( uint32_t thread, const std::vector<TraceEvent>& events ) {
+  unsigned long long counts[ TRACE_RESULT + 1 ] = { 0 };
+  unsigned long long propagated = 0;
+  unsigned long long learnedSize = 0;
+  unsigned long long lbdHistogram[6] = { 0 };
+  unsigned long long jumpLevels = 0;
+  unsigned long long removed = 0;
+  double propagateSeconds = 0;
+  int maxLevel = 0;
+  int result = RESULT_UNKNOWN;
+  if ( events.empty() )
+    return;
+  double start = events.front().time * 1e-9;
+  double end = events.back().time * 1e-9;
+  double span = std::max( end - start, 1e-9 );
+  unsigned long long timeline[ TIMELINE_SLICES ] = { 0 };
+  for ( size_t i = 0; i < events.size(); i++ ) {
+    const TraceEvent& e = events[i];
+    if ( e.type > TRACE_RESULT )
+      continue;
+    counts[ e.type ]++;
+    switch ( e.type ) {
+      case TRACE_DECISION:
+        maxLevel = std::max( maxLevel, e.arg[1] );
+        break;
+      case TRACE_PROPAGATE:
+        propagated += e.arg[0];
+        propagateSeconds += e.arg[2] * 1e-9;
+        break;
+      case TRACE_CONFLICT: {
+        learnedSize += e.arg[0];
+        lbdHistogram[ lbdBucket( e.arg[1] ) ]++;
+        jumpLevels += e.arg[2];
+        int slice = ( e.time * 1e-9 - start ) / span * TIMELINE_SLICES;
+        timeline[ std::min( slice, TIMELINE_SLICES - 1 ) ]++;
+        break;
+      }
+      case TRACE_REDUCE:
+        removed += e.arg[1];
+        break;
+      case TRACE_RESULT:
+        result = e.arg[0];
+        break;
+    }
+  }
+  unsigned long long conflicts = counts[ TRACE_CONFLICT ];
+  std::cout << std::fixed << std::setprecision( 3 );
+  std::cout << "thread " << thread << ": " << events.size() << " events over "
+            << span << "s, result "
+            << ( result == RESULT_SAT ? "sat" : result == RESULT_UNSAT ? "unsat" : "unknown" ) << "\n";
+  std::cout << "  decisions " << counts[ TRACE_DECISION ] << " (deepest level " << maxLevel << ")"
+            << ", conflicts " << conflicts << " (" << conflicts / span << "/s)"
+            << ", restarts " << counts[ TRACE_RESTART ]
+            << ", reductions " << counts[ TRACE_REDUCE ] << " removing " << removed << "\n";
+  std::cout << "  propagation: " << counts[ TRACE_PROPAGATE ] << " batches, " << propagated
+            << " literals, " << propagateSeconds << "s (" << 100 * propagateSeconds / span
+            << "% of the time)\n";
+  if ( conflicts ) {
+    std::cout << "  learned: average size " << (double) learnedSize / conflicts
+              << ", average backjump level " << (double) jumpLevels / conflicts << "\n";
+    const char* buckets[6] = { "1", "2", "3-4", "5-8", "9-16", ">16" };
+    std::cout << "  lbd:";
+    for ( int b = 0; b < 6; b++ )
+      std::cout << " " << buckets[b] << ":" << lbdHistogram[b];
+    std::cout << "\n  conflicts/s by tenth of the run:";
+    for ( int k = 0; k < TIMELINE_SLICES; k++ )
+      std::cout << " " << (unsigned long long) ( timeline[k] / ( span / TIMELINE_SLICES ) );
+    std::cout << "\n";
+  }
+}
+
+// Events as JSON objects of the Chrome trace event format, times in
+// microseconds. Propagation batches become complete events with their
+// duration, everything else instant events with its arguments.
+void writeChrome ( const std::map<uint32_t, ThreadEvents>& threads ) {
+  const char* names[ TRACE_RESULT + 1 ] = { "", "decision", "propagate", "conflict", "restart", "reduce", "result" };
+  const char* args[ TRACE_RESULT + 1 ][3] = {
+    { "", "", "" },
+    { "literal", "level", "" },
+    { "literals", "level", "" },
+    { "size", "lbd", "backjump_level" },
+    { "restarts", "conflicts", "" },
+    { "kept", "removed", "" },
+    { "result", "conflicts", "" }
+  };
+  std::cout << std::fixed << std::setprecision( 3 );
+  std::cout << "{\"traceEvents\": [\n";
+  bool first = true;
+  for ( std::map<uint32_t, ThreadEvents>::const_iterator it = threads.begin(); it != threads.end(); ++it ) {
+    const std::vector<TraceEvent>& events = it->second.events;
+    for ( size_t i = 0; i < events.size(); i++ ) {
+      const TraceEvent& e = events[i];
+      if ( e.type == 0 || e.type > TRACE_RESULT )
+        continue;
+      double ts = e.time * 1e-3;
+      std::cout << ( first ? "" : ",\n" ) << "{\"name\": \"" << names[ e.type ] << "\", \"pid\": 0, \"tid\": " << it->first;
+      first = false;
+      if ( e.type == TRACE_PROPAGATE )
+        std::cout << ", \"ph\": \"X\", \"ts\": " << ts - e.arg[2] * 1e-3 << ", \"dur\": " << e.arg[2] * 1e-3;
+      else
+        std::cout << ", \"ph\": \"i\", \"s\": \"t\", \"ts\": " << ts;
+      std::cout << ", \"args\": {";
+      for ( int k = 0; k < 3 && args[ e.type ][k][0]; k++ )
+        std::cout << ( k ? ", " : "" ) << "\"" << args[ e.type ][k] << "\": " << e.arg[k];
+      std::cout << "}}";
+    }
+  }
+  std::cout << "\n], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+int main ( int argc, char** argv ) {
+  if ( argc != 3 || ( strcmp( argv[1], "summary" ) && strcmp( argv[1], "chrome" ) ) ) {
+    std::cerr << "usage: tracetool summary|chrome TRACE\n";
+    return 2;
+  }
+  std::map<uint32_t, ThreadEvents> threads;
+  if ( !readTrace( argv[2], &threads ) )
+    return 1;
+  if ( !strcmp( argv[1], "chrome" ) ) {
+    writeChrome( threads );
+    return 0;
+  }
+  // chunks of one buffer are written in order, so its events are sorted
+  for ( std::map<uint32_t, ThreadEvents>::const_iterator it = threads.begin(); it != threads.end(); ++it )
+    summarize( it->first, it->second.events );
+  return 0;
+}